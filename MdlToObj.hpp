@@ -24,26 +24,119 @@ SOFTWARE.
 
 #pragma once
 
+#include <map>
 #include <set>
+#include <queue>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <functional>
+#include <algorithm>
 #include <string>
 #include <vector>
+#include <limits>
+#include <cerrno>
+#include <cmath>
+#include <cctype>
 #include <cassert>
+#include <clocale>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <cstdarg>
-#include <fstream>
+#include <cstdio>
 #include <sstream>
 #include <iostream>
 #include <unordered_map>
 
+#if !defined(MDL_TO_OBJ_NO_MMAP)
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#define MDL_TO_OBJ_USE_MMAP
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define MDL_TO_OBJ_USE_MMAP
+#endif
+#endif  // MDL_TO_OBJ_NO_MMAP
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <limits.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#define MDL_TO_OBJ_USE_WRITEV
+#endif
+
+// peak memory of the process, for the stats
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+// write of the file descriptors, for FdSink
+#if defined(_WIN32)
+#include <io.h>
+#endif
+
+// simd scan of the line endings and of the blanks, see MdlToObj::ScanLevel
+// sse2 is the baseline of the x64 cpus, avx2 is used only if the cpu support it
+#if !defined(MDL_TO_OBJ_NO_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MDL_TO_OBJ_USE_SSE2
+#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+#include <immintrin.h>
+#define MDL_TO_OBJ_USE_AVX2
+#if defined(__GNUC__) || defined(__clang__)
+#define MDL_TO_OBJ_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define MDL_TO_OBJ_TARGET_AVX2
+#endif
+#endif
+#endif
+#endif  // MDL_TO_OBJ_NO_SIMD
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 #define MDL_TO_OBJ_VERSION "0.1"
 
 // OBJ file format : https://en.wikipedia.org/wiki/Wavefront_.obj_file
 
 typedef std::array<double, 2U> UV;
 typedef std::array<double, 3U> Vertex;
-typedef std::vector<int32_t> Face;
 typedef std::array<double, 3U> Color;
 
+// storage of the vertices and uvs of the models, see MdlToObj::setPrecision
+enum class Precision { Double = 0, Float, Quantized16 };
+typedef std::array<float, 2U> UVF32;
+typedef std::array<float, 3U> VertexF32;
+typedef std::array<uint16_t, 2U> UVQ16;
+typedef std::array<uint16_t, 3U> VertexQ16;
+
+// unit vector, see MdlToObj::setComputeNormals
+typedef std::array<float, 3U> Normal;
+
+// kernel of the scan of the line endings and of the blanks of the mdl text, see MdlToObj::setScanLevel
+enum class ScanLevel { Scalar = 0, SSE2, AVX2 };
+
 struct Material {
     std::string name;
     double Ns = 0.0;             // specular exponent
@@ -74,388 +167,4707 @@ struct Model {
     Material mat;
     bool smooth_shading = false;
     std::vector<Vertex> vertices;
-    std::vector<Face> faces;
     std::vector<UV> uvs;
+    // the faces are stored contiguously, face after face.
+    // face_sizes is empty while the model contain only triangles,
+    // else it give the count of indices of each face
+    std::vector<int32_t> indices;
+    std::vector<uint32_t> face_sizes;
+    // once compacted, the vertices and uvs are stored in the arrays of the precision, vertices and uvs are empty.
+    // the quantized values are relative to the bounds of the model : value = min + q * step
+    Precision precision = Precision::Double;
+    std::vector<VertexF32> vertices_f32;
+    std::vector<UVF32> uvs_f32;
+    std::vector<VertexQ16> vertices_q16;
+    std::vector<UVQ16> uvs_q16;
+    Vertex vertices_min = {0.0, 0.0, 0.0};
+    Vertex vertices_step = {1.0, 1.0, 1.0};
+    UV uvs_min = {0.0, 0.0};
+    UV uvs_step = {1.0, 1.0};
+    // the computed normals, normal_indices give the normal of each item of indices (from 0).
+    // empty if the normals are not computed
+    std::vector<Normal> normals;
+    std::vector<uint32_t> normal_indices;
+    // the models merged in this one by MdlToObj::setMergeModels, with their ranges of faces and vertices.
+    // empty if the model is not merged
+    struct Part {
+        std::string name;
+        uint32_t first_face = 0U;
+        uint32_t faces_count = 0U;
+        uint32_t first_vertex = 0U;
+        uint32_t vertices_count = 0U;
+    };
+    std::vector<Part> parts;
+
+    // the accessors below work with any precision
+    size_t getVerticesCount() const {
+        switch (precision) {
+            case Precision::Float: return vertices_f32.size();
+            case Precision::Quantized16: return vertices_q16.size();
+            default: return vertices.size();
+        }
+    }
+    size_t getUVsCount() const {
+        switch (precision) {
+            case Precision::Float: return uvs_f32.size();
+            case Precision::Quantized16: return uvs_q16.size();
+            default: return uvs.size();
+        }
+    }
+    Vertex getVertex(const size_t& vIdx) const {
+        switch (precision) {
+            case Precision::Float: {
+                const auto& v = vertices_f32[vIdx];
+                return Vertex{{v[0], v[1], v[2]}};
+            }
+            case Precision::Quantized16: {
+                const auto& q = vertices_q16[vIdx];
+                return Vertex{{vertices_min[0] + q[0] * vertices_step[0], vertices_min[1] + q[1] * vertices_step[1],
+                               vertices_min[2] + q[2] * vertices_step[2]}};
+            }
+            default: return vertices[vIdx];
+        }
+    }
+    UV getUV(const size_t& vIdx) const {
+        switch (precision) {
+            case Precision::Float: {
+                const auto& uv = uvs_f32[vIdx];
+                return UV{{uv[0], uv[1]}};
+            }
+            case Precision::Quantized16: {
+                const auto& q = uvs_q16[vIdx];
+                return UV{{uvs_min[0] + q[0] * uvs_step[0], uvs_min[1] + q[1] * uvs_step[1]}};
+            }
+            default: return uvs[vIdx];
+        }
+    }
+    size_t getFacesCount() const {
+        return face_sizes.empty() ? indices.size() / 3U : face_sizes.size();
+    }
+    // empty the model like a new one, but the arrays and the names keep their capacity for be filled again
+    void clear() {
+        std::string mat_name;
+        std::string ka_texture;
+        mat_name.swap(mat.name);
+        ka_texture.swap(mat.ka_texture);
+        mat = Material();
+        mat.name.swap(mat_name);
+        mat.ka_texture.swap(ka_texture);
+        mat.name.clear();
+        mat.ka_texture.clear();
+        name.clear();
+        smooth_shading = false;
+        vertices.clear();
+        uvs.clear();
+        indices.clear();
+        face_sizes.clear();
+        precision = Precision::Double;
+        vertices_f32.clear();
+        uvs_f32.clear();
+        vertices_q16.clear();
+        uvs_q16.clear();
+        vertices_min = Vertex{{0.0, 0.0, 0.0}};
+        vertices_step = Vertex{{1.0, 1.0, 1.0}};
+        uvs_min = UV{{0.0, 0.0}};
+        uvs_step = UV{{1.0, 1.0}};
+        normals.clear();
+        normal_indices.clear();
+        parts.clear();
+    }
+    void addTriangle(const int32_t& vIdx0, const int32_t& vIdx1, const int32_t& vIdx2) {
+        indices.push_back(vIdx0);
+        indices.push_back(vIdx1);
+        indices.push_back(vIdx2);
+        if (!face_sizes.empty()) {
+            face_sizes.push_back(3U);
+        }
+    }
+    void addFace(const int32_t* vIndices, const size_t& vCount) {
+        if (vCount != 3U && face_sizes.empty()) {
+            face_sizes.resize(indices.size() / 3U, 3U);  // the previous faces was triangles
+        }
+        indices.insert(indices.end(), vIndices, vIndices + vCount);
+        if (!face_sizes.empty()) {
+            face_sizes.push_back((uint32_t)vCount);
+        }
+    }
 };
 
-class MdlToObj {
+// destination of a saved text, see MdlToObj::saveObjToSinks.
+// write receive the successive parts of the text, then close is called once at the end
+class OutputSink {
+public:
+    virtual ~OutputSink() = default;
+    // return false if the text can't be written, the next parts are then not given
+    virtual bool write(const char* vData, const size_t& vSize) = 0;
+    virtual bool close() {
+        return true;
+    }
+};
+
+// keep the text in memory
+class BufferSink : public OutputSink {
 private:
-    std::vector<Model> m_Models;
-    std::string m_SourceFilePathName;
-    std::set<std::string> m_Components;
+    std::string m_Data;
 
 public:
-    bool openMdlFile(const std::string& vFile) {
-        if (m_isFileExist(vFile)) {
-            m_SourceFilePathName = vFile;
-            auto source = m_loadFileToString(vFile);
-            if (!source.empty()) {
-                size_t start_line = 0U;
-                size_t end_line = source.find('\n');
-                std::string component_name;
-                bool mesh_found = false;
-                bool data_found = false;
-                bool uv_found = false;
-                bool polys_found = false;
-                bool texture_found = false;
-                size_t num_uvs = 0U;
-                size_t num_verts = 0U;
-                size_t num_faces = 0U;
-                Model model;
-                Vertex vertex;
-                UV uv;
-                Face face;
-                std::string smooth_shading;
-                std::string surface_name;
-                while (end_line != std::string::npos) {
-                    auto line = source.substr(start_line, end_line - start_line);
-                    m_replaceString(line, "\n", "");
-                    m_replaceString(line, "\r", "");
-                    m_replaceString(line, "\t", "");
-                    if (mesh_found) {
-                        if (m_getValueForKey(line, "NumPolys ", num_faces)) {
-                            data_found = false;
-                            model.faces.reserve(num_faces);  // for speed up next push_back
-                            std::cout << "Faces section found" << std::endl;
-                        } else if (m_getValueForKey(line, "NumVerts ", num_verts)) {
-                            model.vertices.reserve(num_verts);  // for speed up next push_back
-                        } else if (data_found) {
-                            if (uv_found) {
-                                if (m_getVertexUV(line, vertex, uv)) {
-                                    model.vertices.push_back(vertex);
-                                    model.uvs.push_back(uv);
-                                    ++num_uvs;
-                                }
-                            } else {
-                                if (m_getVertex(line, vertex)) {
-                                    model.vertices.push_back(vertex);
-                                }
-                            }
-                        } else if (m_isKeyExist(line, "EndPolygonMesh")) {
-                            if (num_verts) {
-                                std::cout << "Count Vertex : " << num_verts << std::endl;
-                            }
-                            if (num_uvs) {
-                                std::cout << "Count Uvs : " << num_uvs << std::endl;
-                            }
-                            if (num_faces) {
-                                std::cout << "Count Faces : " << num_faces << std::endl;
-                            }
-                            mesh_found = false;
-                            polys_found = false;
-                            m_Models.push_back(model);
-                        } else if (m_isKeyExist(line, "EndTexture")) {
-                            texture_found = false;
-                        } else if (m_isKeyExist(line, "Texture")) {
-                            texture_found = true;
-                        } else if (polys_found) {
-                            /*if (getFace(line, face)) {
-                                model.faces.push_back(face);
-                            } else */ if (m_getFaces(line, model.faces)) {
-                            }
-                        } else if (texture_found) {
-                            if (m_getValueForKey(line, "FRGB ", model.mat.ka_texture)) {
-                                std::cout << "Ka texture found : " << model.mat.ka_texture << std::endl;
-                            }
-                        } else if (m_getValueForKey(line, "FaceColor %", model.mat.Ka)) {
-                        } else if (m_getValueForKey(line, "FaceEmissionColor %", model.mat.Ke)) {
-                        } else if (m_getValueForKey(line, "SmoothShading ", smooth_shading)) {
-                            model.smooth_shading = (smooth_shading != "No");
-                        } else if (m_getValueForKey(line, "Shininess ", model.mat.Ns)) {
-                        } else if (m_getValueForKey(line, "Translucency ", model.mat.d)) {
-                        } else if (m_getValueForKey(line, "Specularity ", model.mat.Ks[0])) {
-                            model.mat.Ks[1] = model.mat.Ks[0];
-                            model.mat.Ks[2] = model.mat.Ks[0];
-                        } else if (m_isKeyExist(line, "Polys")) {
-                            polys_found = true;
-                        } else if (m_isKeyExist(line, "DataTx")) {
-                            data_found = true;
-                            uv_found = true;
-                            std::cout << "Vertices/Uvs section found" << std::endl;
-                        } else if (m_isKeyExist(line, "Data")) {
-                            data_found = true;
-                            std::cout << "Vertices section found" << std::endl;
+    bool write(const char* vData, const size_t& vSize) override {
+        m_Data.append(vData, vSize);
+        return true;
+    }
+    const std::string& getData() const {
+        return m_Data;
+    }
+};
+
+// write the text in a file descriptor opened by the caller, who keep the ownership (a socket, a pipe..)
+class FdSink : public OutputSink {
+private:
+    int m_Fd = -1;
+
+public:
+    explicit FdSink(const int& vFd) : m_Fd(vFd) {
+    }
+    bool write(const char* vData, const size_t& vSize) override {
+        const char* data = vData;
+        size_t size = vSize;
+        while (size) {
+#if defined(_WIN32)
+            const int written = _write(m_Fd, data, (unsigned int)std::min<size_t>(size, 1U << 30U));
+#else
+            const ssize_t written = ::write(m_Fd, data, size);
+#endif
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            data += written;
+            size -= (size_t)written;
+        }
+        return true;
+    }
+};
+
+// give the text to a callback, who return false for stop the writing
+class CallbackSink : public OutputSink {
+private:
+    std::function<bool(const char*, size_t)> m_Callback;
+
+public:
+    explicit CallbackSink(const std::function<bool(const char*, size_t)>& vCallback) : m_Callback(vCallback) {
+    }
+    bool write(const char* vData, const size_t& vSize) override {
+        return m_Callback(vData, vSize);
+    }
+};
+
+class MdlToObj {
+private:
+    // non-owning view on a range of the loaded source buffer
+    struct StrView {
+        static const size_t npos = static_cast<size_t>(-1);
+        const char* ptr = nullptr;
+        size_t size = 0U;
+        StrView() = default;
+        StrView(const char* vPtr, size_t vSize) : ptr(vPtr), size(vSize) {
+        }
+        bool empty() const {
+            return (size == 0U);
+        }
+        const char* begin() const {
+            return ptr;
+        }
+        const char* end() const {
+            return ptr + size;
+        }
+        StrView substr(size_t vPos, size_t vCount = npos) const {
+            if (vPos > size) {
+                vPos = size;
+            }
+            if (vCount > size - vPos) {
+                vCount = size - vPos;
+            }
+            return StrView(ptr + vPos, vCount);
+        }
+        std::string toString() const {
+            return std::string(ptr, size);
+        }
+    };
+
+    // masks of the line endings ('\n') and of the blanks (see m_isBlank) of 64 bytes, the bit n is for the byte n
+    typedef void (*ScanKernel)(const char* vData, uint64_t& vOutNewLines, uint64_t& vOutBlanks);
+
+    static void m_scanScalar(const char* vData, uint64_t& vOutNewLines, uint64_t& vOutBlanks) {
+        uint64_t new_lines = 0U;
+        uint64_t blanks = 0U;
+        for (uint32_t idx = 0U; idx < 64U; ++idx) {
+            new_lines |= static_cast<uint64_t>(vData[idx] == '\n') << idx;
+            blanks |= static_cast<uint64_t>(m_isBlank(vData[idx])) << idx;
+        }
+        vOutNewLines = new_lines;
+        vOutBlanks = blanks;
+    }
+#if defined(MDL_TO_OBJ_USE_SSE2)
+    static void m_scanSSE2(const char* vData, uint64_t& vOutNewLines, uint64_t& vOutBlanks) {
+        const __m128i new_line = _mm_set1_epi8('\n');
+        const __m128i space = _mm_set1_epi8(' ');
+        const __m128i tab = _mm_set1_epi8('\t');
+        const __m128i carriage_return = _mm_set1_epi8('\r');
+        uint64_t new_lines = 0U;
+        uint64_t blanks = 0U;
+        for (uint32_t idx = 0U; idx < 64U; idx += 16U) {
+            const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(vData + idx));
+            const __m128i blank = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chars, space), _mm_cmpeq_epi8(chars, tab)),  //
+                                               _mm_cmpeq_epi8(chars, carriage_return));
+            new_lines |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, new_line)))) << idx;
+            blanks |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(blank))) << idx;
+        }
+        vOutNewLines = new_lines;
+        vOutBlanks = blanks;
+    }
+#endif
+#if defined(MDL_TO_OBJ_USE_AVX2)
+    MDL_TO_OBJ_TARGET_AVX2 static void m_scanAVX2(const char* vData, uint64_t& vOutNewLines, uint64_t& vOutBlanks) {
+        const __m256i new_line = _mm256_set1_epi8('\n');
+        const __m256i space = _mm256_set1_epi8(' ');
+        const __m256i tab = _mm256_set1_epi8('\t');
+        const __m256i carriage_return = _mm256_set1_epi8('\r');
+        uint64_t new_lines = 0U;
+        uint64_t blanks = 0U;
+        for (uint32_t idx = 0U; idx < 64U; idx += 32U) {
+            const __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(vData + idx));
+            const __m256i blank = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chars, space), _mm256_cmpeq_epi8(chars, tab)),  //
+                                                  _mm256_cmpeq_epi8(chars, carriage_return));
+            new_lines |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, new_line)))) << idx;
+            blanks |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(blank))) << idx;
+        }
+        vOutNewLines = new_lines;
+        vOutBlanks = blanks;
+    }
+#endif
+    static bool m_isAVX2Supported() {
+#if defined(MDL_TO_OBJ_USE_AVX2)
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) {
+            return false;
+        }
+        __cpuid(info, 1);
+        const bool os_saves_avx = ((info[2] & (1 << 27)) != 0) && ((info[2] & (1 << 28)) != 0) && ((_xgetbv(0) & 6U) == 6U);
+        __cpuidex(info, 7, 0);
+        return os_saves_avx && ((info[1] & (1 << 5)) != 0);
+#else
+        __builtin_cpu_init();
+        return (__builtin_cpu_supports("avx2") != 0);
+#endif
+#else
+        return false;
+#endif
+    }
+    static ScanKernel m_getScanKernel(const ScanLevel& vLevel) {
+        switch (vLevel) {
+#if defined(MDL_TO_OBJ_USE_AVX2)
+            case ScanLevel::AVX2: return m_scanAVX2;
+#endif
+#if defined(MDL_TO_OBJ_USE_SSE2)
+            case ScanLevel::SSE2: return m_scanSSE2;
+#endif
+            default: return m_scanScalar;
+        }
+    }
+    // kernel used by the next lexers, the best one by default
+    static std::atomic<ScanLevel>& m_getScanLevelRef() {
+        static std::atomic<ScanLevel> s_level(getBestScanLevel());
+        return s_level;
+    }
+    static uint32_t m_getLowestBit(const uint64_t& vMask) {  // vMask must not be 0
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<uint32_t>(__builtin_ctzll(vMask));
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+        unsigned long idx = 0;
+        _BitScanForward64(&idx, vMask);
+        return static_cast<uint32_t>(idx);
+#else
+        uint32_t idx = 0U;
+        while (!((vMask >> idx) & 1U)) {
+            ++idx;
+        }
+        return idx;
+#endif
+    }
+
+    // walks the loaded buffer line by line, without any copy
+    // the line ending (\n or \r\n) is not part of the returned line.
+    // the buffer is scanned by blocks of 64 bytes with the scan kernel, the line endings are then
+    // found in the masks of the block, and the tokens of the line are the ranges between the blanks
+    class LineLexer {
+    private:
+        const char* m_Begin = nullptr;
+        size_t m_Size = 0U;
+        size_t m_Pos = 0U;
+        ScanKernel m_Kernel = nullptr;
+        size_t m_BlockPos = 0U;    // offset of the scanned block
+        uint64_t m_NewLines = 0U;  // masks of the scanned block
+        uint64_t m_Blanks = 0U;
+
+        void m_scanBlock(const size_t& vBlockPos) {
+            m_BlockPos = vBlockPos;
+            const size_t size = m_Size - vBlockPos;
+            if (size >= 64U) {
+                m_Kernel(m_Begin + vBlockPos, m_NewLines, m_Blanks);
+            } else {  // the last block is copied for not read after the buffer, the bytes after the end are blanks
+                char tail[64] = {};
+                memcpy(tail, m_Begin + vBlockPos, size);
+                m_Kernel(tail, m_NewLines, m_Blanks);
+                m_Blanks |= ~((1ULL << size) - 1U);
+            }
+        }
+        // add the tokens of the bytes [vFirst:vLast[ of the scanned block.
+        // vioTokenBegin is the begin of the token not ended at the end of the previous block
+        void m_addTokens(const uint32_t& vFirst, const uint32_t& vLast, const char*& vioTokenBegin, std::vector<StrView>& vioTokens) const {
+            const uint64_t range = ((vLast < 64U) ? ((1ULL << vLast) - 1U) : ~0ULL) & (~0ULL << vFirst);
+            const uint64_t chars = ~m_Blanks & range;
+            uint64_t starts = chars & ~(chars << 1U);
+            uint64_t ends = chars & ~(chars >> 1U);  // last chars of the tokens
+            const char* block = m_Begin + m_BlockPos;
+            if (vioTokenBegin != nullptr) {
+                if (chars & 1U) {
+                    starts &= ~1ULL;
+                } else {  // the token was ended by the end of the previous block
+                    vioTokens.push_back(StrView(vioTokenBegin, static_cast<size_t>(block - vioTokenBegin)));
+                    vioTokenBegin = nullptr;
+                }
+            }
+            if (vLast == 64U) {
+                ends &= ~(1ULL << 63U);  // the token can continue in the next block
+            }
+            while (ends) {
+                const uint32_t end = m_getLowestBit(ends);
+                ends &= ends - 1U;
+                if (vioTokenBegin == nullptr) {
+                    vioTokenBegin = block + m_getLowestBit(starts);
+                    starts &= starts - 1U;
+                }
+                vioTokens.push_back(StrView(vioTokenBegin, static_cast<size_t>(block + end + 1U - vioTokenBegin)));
+                vioTokenBegin = nullptr;
+            }
+            if (starts) {
+                vioTokenBegin = block + m_getLowestBit(starts);
+            }
+        }
+
+    public:
+        LineLexer(const char* vBuffer, size_t vSize) : m_Begin(vBuffer), m_Size(vSize), m_Kernel(m_getScanKernel(m_getScanLevelRef().load())) {
+            if (m_Size) {
+                m_scanBlock(0U);
+            }
+        }
+        // offset of the next line from the buffer begin
+        size_t getOffset() const {
+            return (m_Pos < m_Size ? m_Pos : m_Size);
+        }
+        // vOutTokens receive the blank separated tokens of the line, if not null
+        bool next(StrView& vOutLine, std::vector<StrView>* vOutTokens = nullptr) {
+            if (m_Pos >= m_Size) {
+                return false;
+            }
+            if (m_Pos - m_BlockPos >= 64U) {
+                m_scanBlock(m_BlockPos + 64U);
+            }
+            if (vOutTokens != nullptr) {
+                vOutTokens->clear();
+            }
+            const size_t begin_line = m_Pos;
+            const char* token_begin = nullptr;
+            size_t end_line = m_Size;  // last line without line ending
+            while (true) {
+                const uint32_t first = static_cast<uint32_t>(m_Pos - m_BlockPos);
+                const uint64_t new_lines = m_NewLines & (~0ULL << first);
+                const uint32_t last = new_lines ? m_getLowestBit(new_lines) : 64U;
+                if (vOutTokens != nullptr) {
+                    m_addTokens(first, last, token_begin, *vOutTokens);
+                }
+                if (new_lines) {
+                    end_line = m_BlockPos + last;
+                    m_Pos = end_line + 1U;
+                    break;
+                }
+                if (m_BlockPos + 64U >= m_Size) {
+                    m_Pos = m_Size;
+                    break;
+                }
+                m_scanBlock(m_BlockPos + 64U);
+                m_Pos = m_BlockPos;
+            }
+            if (token_begin != nullptr) {
+                vOutTokens->push_back(StrView(token_begin, static_cast<size_t>(m_Begin + end_line - token_begin)));
+            }
+            vOutLine = StrView(m_Begin + begin_line, end_line - begin_line);
+            if (!vOutLine.empty() && vOutLine.ptr[vOutLine.size - 1U] == '\r') {
+                --vOutLine.size;
+            }
+            return true;
+        }
+    };
+
+    // buffered text writer.
+    // when a file is opened, the text is formatted in a fixed size buffer who is flushed to the file each time he is full.
+    // else the buffer grow and keep the whole text, see data() and size()
+    class TextWriter {
+    private:
+        std::FILE* m_File = nullptr;
+        OutputSink* m_Sink = nullptr;  // used in place of m_File when set
+        std::vector<char> m_Buffer;
+        size_t m_Size = 0U;
+        uint64_t m_WrittenSize = 0U;
+        bool m_Failed = false;
+
+    public:
+        explicit TextWriter(size_t vCapacity = 256U * 1024U) : m_Buffer(vCapacity) {
+        }
+        TextWriter(const TextWriter&) = delete;
+        TextWriter& operator=(const TextWriter&) = delete;
+        TextWriter(TextWriter&& vOther)
+            : m_File(vOther.m_File),
+              m_Sink(vOther.m_Sink),
+              m_Buffer(std::move(vOther.m_Buffer)),
+              m_Size(vOther.m_Size),
+              m_WrittenSize(vOther.m_WrittenSize),
+              m_Failed(vOther.m_Failed) {
+            vOther.m_File = nullptr;
+            vOther.m_Sink = nullptr;
+            vOther.m_Size = 0U;
+        }
+        ~TextWriter() {
+            close();
+        }
+        bool open(const std::string& vFilePathName, const bool& vBinary = false) {
+            close();
+            m_Size = 0U;
+            m_WrittenSize = 0U;
+            m_File = std::fopen(vFilePathName.c_str(), vBinary ? "wb" : "w");
+            if (m_File != nullptr) {
+                std::setvbuf(m_File, nullptr, _IONBF, 0);  // our buffer is enough
+                m_Failed = false;
+                return true;
+            }
+            return false;
+        }
+        // the text is given to vSink instead of a file
+        bool open(OutputSink& vSink) {
+            close();
+            m_Size = 0U;
+            m_WrittenSize = 0U;
+            m_Sink = &vSink;
+            m_Failed = false;
+            return true;
+        }
+        // flush and close the file or the sink, return false if something was not written
+        bool close() {
+            if (m_File != nullptr) {
+                m_flush();
+                m_Failed |= (std::fclose(m_File) != 0);
+                m_File = nullptr;
+                return !m_Failed;
+            }
+            if (m_Sink != nullptr) {
+                m_flush();
+                m_Failed |= !m_Sink->close();
+                m_Sink = nullptr;
+                return !m_Failed;
+            }
+            return false;
+        }
+        // the text kept in memory when no file is opened
+        const char* data() const {
+            return m_Buffer.data();
+        }
+        size_t size() const {
+            return m_Size;
+        }
+        void clear() {
+            m_Size = 0U;
+        }
+        // bytes written in the file since the open
+        uint64_t getWrittenSize() const {
+            return m_WrittenSize;
+        }
+        void write(const char* vData, size_t vSize) {
+            if (m_isOpened() && vSize > m_Buffer.size() - m_Size) {
+                m_flush();
+                if (vSize > m_Buffer.size()) {
+                    m_writeToFile(vData, vSize);
+                    return;
+                }
+            }
+            memcpy(m_reserve(vSize), vData, vSize);
+            m_Size += vSize;
+        }
+        template <size_t N>
+        void write(const char (&vStr)[N]) {
+            write(vStr, N - 1U);
+        }
+        void write(const std::string& vStr) {
+            write(vStr.data(), vStr.size());
+        }
+        void write(const char& vChar) {
+            m_reserve(1U)[0] = vChar;
+            ++m_Size;
+        }
+        void writeUInt(const uint32_t& vValue) {
+            m_Size += m_formatUInt(m_reserve(16U), vValue);
+        }
+        void writeInt(const int32_t& vValue) {
+            m_Size += m_formatInt(m_reserve(16U), vValue);
+        }
+        // same as printf("%.6f")
+        void writeFixed6(const double& vValue) {
+            m_Size += m_formatFixed6(m_reserve(s_MaxFixed6Size), vValue);
+        }
+        // write the texts of other writers in the file, in one vectored write when possible
+        void writeTexts(const TextWriter* vWriters, const size_t& vCount) {
+            m_flush();
+#if defined(MDL_TO_OBJ_USE_WRITEV)
+            if (m_File != nullptr) {
+                std::vector<struct iovec> iovs;
+                iovs.reserve(vCount);
+                for (size_t idx = 0U; idx < vCount; ++idx) {
+                    if (vWriters[idx].size()) {
+                        iovs.push_back({const_cast<char*>(vWriters[idx].data()), vWriters[idx].size()});
+                    }
+                }
+                m_writeVectorToFile(iovs);
+                return;
+            }
+#endif
+            for (size_t idx = 0U; idx < vCount; ++idx) {
+                write(vWriters[idx].data(), vWriters[idx].size());
+            }
+        }
+
+    private:
+        bool m_isOpened() const {
+            return (m_File != nullptr || m_Sink != nullptr);
+        }
+        char* m_reserve(size_t vSize) {
+            if (vSize > m_Buffer.size() - m_Size) {
+                if (m_isOpened()) {
+                    m_flush();
+                } else {
+                    m_Buffer.resize(std::max(m_Buffer.size() * 2U, m_Size + vSize));
+                }
+            }
+            return m_Buffer.data() + m_Size;
+        }
+        void m_flush() {
+            if (m_Size && m_isOpened()) {
+                m_writeToFile(m_Buffer.data(), m_Size);
+                m_Size = 0U;
+            }
+        }
+        void m_writeToFile(const char* vData, size_t vSize) {
+            if (m_Sink != nullptr) {
+                if (!m_Failed) {
+                    m_Failed = !m_Sink->write(vData, vSize);
+                    m_WrittenSize += m_Failed ? 0U : vSize;
+                }
+            } else if (m_File != nullptr) {
+                const auto written = std::fwrite(vData, 1U, vSize, m_File);
+                m_WrittenSize += written;
+                m_Failed |= (written != vSize);
+            }
+        }
+#if defined(MDL_TO_OBJ_USE_WRITEV)
+        void m_writeVectorToFile(std::vector<struct iovec>& vIovs) {
+#if defined(IOV_MAX)
+            const size_t max_iovs = IOV_MAX;
+#else
+            const size_t max_iovs = 1024U;
+#endif
+            const int fd = fileno(m_File);
+            size_t first = 0U;
+            while (first < vIovs.size() && !m_Failed) {
+                const int count = (int)std::min(vIovs.size() - first, max_iovs);
+                const ssize_t written = ::writev(fd, &vIovs[first], count);
+                if (written < 0) {
+                    m_Failed = (errno != EINTR);
+                    continue;
+                }
+                m_WrittenSize += (uint64_t)written;
+                // skip the fully written buffers, and advance in the partially written one
+                auto remaining = (size_t)written;
+                while (first < vIovs.size() && remaining >= vIovs[first].iov_len) {
+                    remaining -= vIovs[first].iov_len;
+                    ++first;
+                }
+                if (remaining) {
+                    vIovs[first].iov_base = static_cast<char*>(vIovs[first].iov_base) + remaining;
+                    vIovs[first].iov_len -= remaining;
+                }
+            }
+        }
+#endif
+    };
+
+    // read only access to the content of a file.
+    // the file is memory mapped when possible, else he is read in one buffered read
+    class InputFile {
+    private:
+        const char* m_Data = nullptr;
+        size_t m_Size = 0U;
+        std::vector<char> m_Buffer;  // used when the file is not mapped
+#if defined(MDL_TO_OBJ_USE_MMAP)
+#ifdef _WIN32
+        HANDLE m_File = INVALID_HANDLE_VALUE;
+        HANDLE m_Mapping = nullptr;
+#endif
+        void* m_MappedData = nullptr;
+#endif
+
+    public:
+        InputFile() = default;
+        InputFile(const InputFile&) = delete;
+        InputFile& operator=(const InputFile&) = delete;
+        ~InputFile() {
+            close();
+        }
+        bool open(const std::string& vFilePathName, const bool& vUseMapping) {
+            close();
+#if defined(MDL_TO_OBJ_USE_MMAP)
+            if (vUseMapping) {
+                int mapped = m_map(vFilePathName);
+                if (mapped >= 0) {
+                    return (mapped > 0);
+                }  // else try the buffered read
+            }
+#else
+            (void)vUseMapping;
+#endif
+            return m_read(vFilePathName);
+        }
+        void close() {
+#if defined(MDL_TO_OBJ_USE_MMAP)
+#ifdef _WIN32
+            if (m_MappedData != nullptr) {
+                UnmapViewOfFile(m_MappedData);
+            }
+            if (m_Mapping != nullptr) {
+                CloseHandle(m_Mapping);
+            }
+            if (m_File != INVALID_HANDLE_VALUE) {
+                CloseHandle(m_File);
+            }
+            m_Mapping = nullptr;
+            m_File = INVALID_HANDLE_VALUE;
+#else
+            if (m_MappedData != nullptr) {
+                munmap(m_MappedData, m_Size);
+            }
+#endif
+            m_MappedData = nullptr;
+#endif
+            m_Buffer.clear();
+            m_Data = nullptr;
+            m_Size = 0U;
+        }
+        const char* data() const {
+            return m_Data;
+        }
+        size_t size() const {
+            return m_Size;
+        }
+        bool isMapped() const {
+#if defined(MDL_TO_OBJ_USE_MMAP)
+            return (m_MappedData != nullptr);
+#else
+            return false;
+#endif
+        }
+
+    private:
+        bool m_read(const std::string& vFilePathName) {
+            auto file = std::fopen(vFilePathName.c_str(), "rb");
+            if (file != nullptr) {
+                bool res = false;
+                if (std::fseek(file, 0, SEEK_END) == 0) {
+                    const long size = std::ftell(file);
+                    if (size >= 0 && std::fseek(file, 0, SEEK_SET) == 0) {
+                        m_Buffer.resize((size_t)size);
+                        m_Size = std::fread(m_Buffer.data(), 1U, m_Buffer.size(), file);
+                        m_Data = m_Buffer.data();
+                        res = (m_Size == m_Buffer.size());
+                    }
+                }
+                std::fclose(file);
+                return res;
+            }
+            return false;
+        }
+#if defined(MDL_TO_OBJ_USE_MMAP)
+        // return 1 if mapped, 0 if the file cant be opened, -1 if the file cant be mapped
+        int m_map(const std::string& vFilePathName) {
+#ifdef _WIN32
+            m_File = CreateFileA(vFilePathName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                 FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (m_File == INVALID_HANDLE_VALUE) {
+                return 0;
+            }
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(m_File, &size) || (uint64_t)size.QuadPart > (uint64_t)SIZE_MAX) {
+                close();
+                return -1;
+            }
+            if (size.QuadPart == 0) {
+                return 1;  // nothing to map
+            }
+            m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (m_Mapping != nullptr) {
+                m_MappedData = MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0);
+            }
+            if (m_MappedData == nullptr) {
+                close();
+                return -1;
+            }
+            m_Size = (size_t)size.QuadPart;
+#else
+            const int fd = ::open(vFilePathName.c_str(), O_RDONLY);
+            if (fd < 0) {
+                return 0;
+            }
+            struct stat st;
+            if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || (uint64_t)st.st_size > (uint64_t)SIZE_MAX) {
+                ::close(fd);
+                return -1;
+            }
+            if (st.st_size == 0) {
+                ::close(fd);
+                return 1;  // nothing to map
+            }
+            void* ptr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);  // the mapping stay valid
+            if (ptr == MAP_FAILED) {
+                return -1;
+            }
+            m_MappedData = ptr;
+            m_Size = (size_t)st.st_size;
+            posix_madvise(m_MappedData, m_Size, POSIX_MADV_SEQUENTIAL);
+#endif
+            m_Data = static_cast<const char*>(m_MappedData);
+            return 1;
+        }
+#endif
+    };
+
+    // section of a PolygonMesh block, the directives move the parser between them :
+    // Data / DataTx -> Vertices, NumPolys -> Properties, Polys -> Faces, Texture -> Texture, EndTexture -> Properties
+    enum class MeshSection { Properties = 0, Vertices, Faces, Texture };
+
+    // state of the parser inside a PolygonMesh block
+    struct MeshState {
+        MeshSection section = MeshSection::Properties;
+        bool uv_found = false;
+        size_t num_uvs = 0U;
+        size_t num_verts = 0U;
+        size_t num_faces = 0U;
+        std::string smooth_shading;
+    };
+
+    // a PolygonMesh block found by the scan of the file, or given by the index file
+    struct MeshBlock {
+        std::string name;
+        std::string component;  // names of the Component and of the Surface who precede the block
+        std::string surface;
+        size_t begin = 0U;   // offset of the line after PolygonMesh
+        size_t end = 0U;     // offset of the line after EndPolygonMesh
+        bool ended = false;  // false if the file end before EndPolygonMesh
+        // counts given by NumVerts and NumPolys, or the parsed counts once the bounds known
+        uint64_t vertices_count = 0U;
+        uint64_t faces_count = 0U;
+        Vertex bounds_min = {0.0, 0.0, 0.0};
+        Vertex bounds_max = {0.0, 0.0, 0.0};
+        uint64_t hash = 0U;  // of the text of the block, given by the index file
+    };
+
+    // arrays used by the parse of a block, reused between the lines and between the files
+    struct MeshBuffers {
+        std::vector<StrView> tokens;
+        std::vector<int32_t> face_values;
+    };
+
+    // storage kept between the files, see MdlToObj::reset. the released models are empty but keep the
+    // capacity of their arrays, they are sorted from the smallest to the biggest for be given to the biggest blocks
+    struct Arena {
+        std::vector<Model> models;
+        std::vector<MeshBlock> blocks;
+        std::vector<size_t> selected;  // the blocks matching the component filter
+        std::vector<size_t> order;
+        std::vector<MeshBuffers> buffers;  // one by block parsed at the same time
+        std::vector<char> unzipped;        // the mdl entry of the zip files
+    };
+
+    // the directives of the mdl files, given by the first token of the lines
+    enum class Keyword {
+        None = 0,  // comment, vertex or face line
+        Component,
+        Surface,  // "# Surface: name" comment
+        PolygonMesh,
+        EndPolygonMesh,
+        NumVerts,
+        NumPolys,
+        Data,
+        DataTx,
+        Polys,
+        Texture,
+        EndTexture,
+        FRGB,
+        FaceColor,
+        FaceEmissionColor,
+        SmoothShading,
+        Shininess,
+        Translucency,
+        Specularity
+    };
+
+    // raw deflate decoder (RFC 1951), for the deflated entries of the zip files
+    class Inflater {
+    private:
+        // canonical huffman table, the codes of at most s_FastBits bits are decoded with one lookup
+        static const uint32_t s_FastBits = 10U;
+        struct Huffman {
+            uint16_t fast[1U << s_FastBits];  // (symbol << 4) | length, 0 if the code is longer
+            uint16_t counts[16];              // count of codes by length
+            uint16_t symbols[288];            // symbols sorted by code
+        };
+        const uint8_t* m_Src = nullptr;
+        const uint8_t* m_SrcEnd = nullptr;
+        uint8_t* m_Dst = nullptr;
+        size_t m_DstSize = 0U;
+        size_t m_DstPos = 0U;
+        uint64_t m_Bits = 0U;
+        uint32_t m_BitsCount = 0U;
+        Huffman m_LitLen;
+        Huffman m_Dist;
+
+    public:
+        // inflate [vSrc:vSrc + vSrcSize[ in vDst, who must have exactly the size of the inflated data
+        bool inflate(const uint8_t* vSrc, const size_t& vSrcSize, uint8_t* vDst, const size_t& vDstSize) {
+            m_Src = vSrc;
+            m_SrcEnd = vSrc + vSrcSize;
+            m_Dst = vDst;
+            m_DstSize = vDstSize;
+            m_DstPos = 0U;
+            m_Bits = 0U;
+            m_BitsCount = 0U;
+            uint32_t last = 0U;
+            do {
+                last = m_getBits(1U);
+                const auto type = m_getBits(2U);
+                bool ok = false;
+                if (type == 0U) {
+                    ok = m_stored();
+                } else if (type == 1U) {
+                    ok = m_fixedTables() && m_codes();
+                } else if (type == 2U) {
+                    ok = m_dynamicTables() && m_codes();
+                }
+                if (!ok) {
+                    return false;
+                }
+            } while (!last);
+            return (m_DstPos == m_DstSize);
+        }
+
+    private:
+        void m_refill() {
+            while (m_BitsCount <= 56U && m_Src < m_SrcEnd) {
+                m_Bits |= (uint64_t)(*m_Src++) << m_BitsCount;
+                m_BitsCount += 8U;
+            }
+        }
+        uint32_t m_getBits(const uint32_t& vCount) {
+            if (m_BitsCount < vCount) {
+                m_refill();
+                if (m_BitsCount < vCount) {
+                    m_BitsCount = vCount;  // out of data, the next checks will fail on the read zeros
+                }
+            }
+            const auto res = (uint32_t)(m_Bits & ((1ULL << vCount) - 1U));
+            m_Bits >>= vCount;
+            m_BitsCount -= vCount;
+            return res;
+        }
+        bool m_stored() {
+            // skip the bits up to the next byte
+            m_getBits(m_BitsCount % 8U);
+            const auto len = m_getBits(16U);
+            const auto nlen = m_getBits(16U);
+            if (len != (~nlen & 0xFFFFU) || len > m_DstSize - m_DstPos) {
+                return false;
+            }
+            size_t remaining = len;
+            while (remaining && m_BitsCount >= 8U) {  // bytes already in the bit buffer
+                m_Dst[m_DstPos++] = (uint8_t)m_getBits(8U);
+                --remaining;
+            }
+            if (remaining > (size_t)(m_SrcEnd - m_Src)) {
+                return false;
+            }
+            memcpy(m_Dst + m_DstPos, m_Src, remaining);
+            m_Src += remaining;
+            m_DstPos += remaining;
+            return true;
+        }
+        static bool m_build(Huffman& vHuffman, const uint8_t* vLengths, const uint32_t& vCount) {
+            memset(vHuffman.counts, 0, sizeof(vHuffman.counts));
+            memset(vHuffman.fast, 0, sizeof(vHuffman.fast));
+            for (uint32_t idx = 0U; idx < vCount; ++idx) {
+                ++vHuffman.counts[vLengths[idx]];
+            }
+            vHuffman.counts[0] = 0U;
+            uint16_t offsets[16];
+            offsets[1] = 0U;
+            int32_t left = 1;
+            for (uint32_t len = 1U; len < 16U; ++len) {
+                left = (left << 1) - vHuffman.counts[len];
+                if (left < 0) {
+                    return false;  // over subscribed
+                }
+                if (len < 15U) {
+                    offsets[len + 1U] = (uint16_t)(offsets[len] + vHuffman.counts[len]);
+                }
+            }
+            uint32_t code = 0U;
+            uint32_t next_code[16];
+            for (uint32_t len = 1U; len < 16U; ++len) {
+                code = (code + (len > 1U ? vHuffman.counts[len - 1U] : 0U)) << 1U;
+                next_code[len] = code;
+            }
+            for (uint32_t symbol = 0U; symbol < vCount; ++symbol) {
+                const uint32_t len = vLengths[symbol];
+                if (len) {
+                    vHuffman.symbols[offsets[len]++] = (uint16_t)symbol;
+                    if (len <= s_FastBits) {
+                        // the codes are read from the lsb, so the lookup index is the reversed code
+                        uint32_t reversed = 0U;
+                        const uint32_t c = next_code[len];
+                        for (uint32_t bit = 0U; bit < len; ++bit) {
+                            reversed |= ((c >> bit) & 1U) << (len - 1U - bit);
+                        }
+                        for (uint32_t idx = reversed; idx < (1U << s_FastBits); idx += (1U << len)) {
+                            vHuffman.fast[idx] = (uint16_t)((symbol << 4U) | len);
                         }
-                    } else if (m_getValueForKey(line, "Component ", component_name)) {
-                    } else if (m_getValueForKey(line, "Surface: ", surface_name)) {
-                    } else if (m_isKeyExist(line, "PolygonMesh")) {
-                        auto name = component_name;
-                        if (!surface_name.empty() && surface_name != component_name) {
-                            name += "_" + surface_name;
+                    }
+                    ++next_code[len];
+                }
+            }
+            return true;
+        }
+        int32_t m_decode(const Huffman& vHuffman) {
+            if (m_BitsCount < 15U) {
+                m_refill();
+            }
+            const auto fast = vHuffman.fast[m_Bits & ((1U << s_FastBits) - 1U)];
+            if (fast && (fast & 15U) <= m_BitsCount) {
+                m_Bits >>= (fast & 15U);
+                m_BitsCount -= (fast & 15U);
+                return fast >> 4U;
+            }
+            // canonical decode, bit after bit
+            int32_t code = 0;
+            int32_t first = 0;
+            int32_t index = 0;
+            for (uint32_t len = 1U; len < 16U; ++len) {
+                code |= (int32_t)m_getBits(1U);
+                const int32_t count = vHuffman.counts[len];
+                if (code - count < first) {
+                    return vHuffman.symbols[index + (code - first)];
+                }
+                index += count;
+                first += count;
+                first <<= 1;
+                code <<= 1;
+            }
+            return -1;
+        }
+        bool m_fixedTables() {
+            uint8_t lengths[288 + 30];
+            uint32_t idx = 0U;
+            for (; idx < 144U; ++idx) {
+                lengths[idx] = 8U;
+            }
+            for (; idx < 256U; ++idx) {
+                lengths[idx] = 9U;
+            }
+            for (; idx < 280U; ++idx) {
+                lengths[idx] = 7U;
+            }
+            for (; idx < 288U; ++idx) {
+                lengths[idx] = 8U;
+            }
+            for (; idx < 288U + 30U; ++idx) {
+                lengths[idx] = 5U;
+            }
+            return m_build(m_LitLen, lengths, 288U) && m_build(m_Dist, lengths + 288U, 30U);
+        }
+        bool m_dynamicTables() {
+            static const uint8_t s_order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+            const uint32_t nlen = m_getBits(5U) + 257U;
+            const uint32_t ndist = m_getBits(5U) + 1U;
+            const uint32_t ncode = m_getBits(4U) + 4U;
+            if (nlen > 286U || ndist > 30U) {
+                return false;
+            }
+            uint8_t lengths[288 + 32];
+            memset(lengths, 0, sizeof(lengths));
+            for (uint32_t idx = 0U; idx < ncode; ++idx) {
+                lengths[s_order[idx]] = (uint8_t)m_getBits(3U);
+            }
+            Huffman code_lengths;
+            if (!m_build(code_lengths, lengths, 19U)) {
+                return false;
+            }
+            uint32_t idx = 0U;
+            while (idx < nlen + ndist) {
+                const auto symbol = m_decode(code_lengths);
+                if (symbol < 0) {
+                    return false;
+                }
+                if (symbol < 16) {
+                    lengths[idx++] = (uint8_t)symbol;
+                } else {
+                    uint8_t len = 0U;
+                    uint32_t repeat = 0U;
+                    if (symbol == 16) {
+                        if (idx == 0U) {
+                            return false;
                         }
-                        uint32_t idx = 0U;
-                        while (m_Components.find(name) != m_Components.end()) {
-                            name = m_toStr("%s_%u", component_name.c_str(), idx++);
+                        len = lengths[idx - 1U];
+                        repeat = 3U + m_getBits(2U);
+                    } else if (symbol == 17) {
+                        repeat = 3U + m_getBits(3U);
+                    } else {
+                        repeat = 11U + m_getBits(7U);
+                    }
+                    if (idx + repeat > nlen + ndist) {
+                        return false;
+                    }
+                    while (repeat--) {
+                        lengths[idx++] = len;
+                    }
+                }
+            }
+            if (lengths[256] == 0U) {
+                return false;  // no end of block code
+            }
+            return m_build(m_LitLen, lengths, nlen) && m_build(m_Dist, lengths + nlen, ndist);
+        }
+        bool m_codes() {
+            static const uint16_t s_len_base[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                                    31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+            static const uint8_t s_len_extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+            static const uint16_t s_dist_base[30] = {1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+                                                     193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+            static const uint8_t s_dist_extra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+            for (;;) {
+                auto symbol = m_decode(m_LitLen);
+                if (symbol < 0) {
+                    return false;
+                } else if (symbol < 256) {
+                    if (m_DstPos >= m_DstSize) {
+                        return false;
+                    }
+                    m_Dst[m_DstPos++] = (uint8_t)symbol;
+                } else if (symbol == 256) {
+                    return true;  // end of block
+                } else {
+                    symbol -= 257;
+                    if (symbol >= 29) {
+                        return false;
+                    }
+                    const size_t len = s_len_base[symbol] + m_getBits(s_len_extra[symbol]);
+                    const auto dist_symbol = m_decode(m_Dist);
+                    if (dist_symbol < 0 || dist_symbol >= 30) {
+                        return false;
+                    }
+                    const size_t dist = s_dist_base[dist_symbol] + m_getBits(s_dist_extra[dist_symbol]);
+                    if (dist > m_DstPos || len > m_DstSize - m_DstPos) {
+                        return false;
+                    }
+                    // byte after byte, since the copy can overlap
+                    const uint8_t* from = m_Dst + m_DstPos - dist;
+                    uint8_t* to = m_Dst + m_DstPos;
+                    for (size_t idx = 0U; idx < len; ++idx) {
+                        to[idx] = from[idx];
+                    }
+                    m_DstPos += len;
+                }
+            }
+        }
+    };
+
+    // read only access to the entries of a zip file in memory (no zip64, no encryption)
+    class ZipArchive {
+    public:
+        struct Entry {
+            std::string name;
+            uint16_t method = 0U;  // 0: stored, 8: deflated
+            uint16_t flags = 0U;
+            uint32_t crc = 0U;
+            uint32_t compressed_size = 0U;
+            uint32_t size = 0U;
+            uint32_t local_header_offset = 0U;
+        };
+
+    private:
+        const uint8_t* m_Data = nullptr;
+        size_t m_Size = 0U;
+        std::vector<Entry> m_Entries;
+
+    public:
+        static bool isZip(const char* vData, const size_t& vSize) {
+            return (vSize >= 4U && memcmp(vData, "PK\x03\x04", 4U) == 0);
+        }
+        // read the central directory
+        bool open(const char* vData, const size_t& vSize) {
+            m_Data = reinterpret_cast<const uint8_t*>(vData);
+            m_Size = vSize;
+            m_Entries.clear();
+            // the end of central directory record is at the end, followed by a comment of at most 65535 bytes
+            if (m_Size < 22U) {
+                return false;
+            }
+            size_t eocd = m_Size - 22U;
+            const size_t min_eocd = (m_Size > 22U + 0xFFFFU) ? m_Size - 22U - 0xFFFFU : 0U;
+            while (m_read32(eocd) != 0x06054b50U) {
+                if (eocd == min_eocd) {
+                    return false;
+                }
+                --eocd;
+            }
+            const uint32_t count = m_read16(eocd + 10U);
+            size_t pos = m_read32(eocd + 16U);
+            for (uint32_t idx = 0U; idx < count; ++idx) {
+                if (pos + 46U > m_Size || m_read32(pos) != 0x02014b50U) {
+                    return false;
+                }
+                Entry entry;
+                entry.flags = m_read16(pos + 8U);
+                entry.method = m_read16(pos + 10U);
+                entry.crc = m_read32(pos + 16U);
+                entry.compressed_size = m_read32(pos + 20U);
+                entry.size = m_read32(pos + 24U);
+                const size_t name_len = m_read16(pos + 28U);
+                const size_t extra_len = m_read16(pos + 30U);
+                const size_t comment_len = m_read16(pos + 32U);
+                entry.local_header_offset = m_read32(pos + 42U);
+                if (pos + 46U + name_len > m_Size) {
+                    return false;
+                }
+                entry.name.assign(reinterpret_cast<const char*>(m_Data + pos + 46U), name_len);
+                m_Entries.push_back(entry);
+                pos += 46U + name_len + extra_len + comment_len;
+            }
+            return true;
+        }
+        const std::vector<Entry>& getEntries() const {
+            return m_Entries;
+        }
+        // first file entry with this extension, case insensitive
+        const Entry* findByExt(const std::string& vExt) const {
+            for (const auto& entry : m_Entries) {
+                if (entry.name.size() >= vExt.size() && m_isSameNoCase(entry.name.substr(entry.name.size() - vExt.size()), vExt)) {
+                    return &entry;
+                }
+            }
+            return nullptr;
+        }
+        // first entry with this file name, whatever its directory in the archive, case insensitive
+        const Entry* findByFileName(const std::string& vFileName) const {
+            for (const auto& entry : m_Entries) {
+                if (m_isSameNoCase(m_getFileName(entry.name), vFileName)) {
+                    return &entry;
+                }
+            }
+            return nullptr;
+        }
+        // give the content of the entry. a stored entry point directly in the archive,
+        // a deflated entry is inflated in vBuffer. the crc is checked
+        bool getData(const Entry& vEntry, std::vector<char>& vBuffer, const char*& vOutData, size_t& vOutSize) const {
+            const size_t pos = vEntry.local_header_offset;
+            if ((vEntry.flags & 1U) || pos + 30U > m_Size || m_read32(pos) != 0x04034b50U) {
+                return false;  // encrypted or bad header
+            }
+            const size_t data_pos = pos + 30U + m_read16(pos + 26U) + m_read16(pos + 28U);
+            if (data_pos > m_Size || vEntry.compressed_size > m_Size - data_pos) {
+                return false;
+            }
+            const uint8_t* src = m_Data + data_pos;
+            if (vEntry.method == 0U) {
+                if (vEntry.compressed_size != vEntry.size) {
+                    return false;
+                }
+                vOutData = reinterpret_cast<const char*>(src);
+            } else if (vEntry.method == 8U) {
+                vBuffer.resize(vEntry.size);
+                Inflater inflater;
+                if (!inflater.inflate(src, vEntry.compressed_size, reinterpret_cast<uint8_t*>(vBuffer.data()), vBuffer.size())) {
+                    return false;
+                }
+                vOutData = vBuffer.data();
+            } else {
+                return false;  // not supported
+            }
+            vOutSize = vEntry.size;
+            return (m_crc32(reinterpret_cast<const uint8_t*>(vOutData), vOutSize) == vEntry.crc);
+        }
+
+    private:
+        uint32_t m_read16(const size_t& vPos) const {
+            return (vPos + 2U <= m_Size) ? (uint32_t)(m_Data[vPos] | (m_Data[vPos + 1U] << 8U)) : 0U;
+        }
+        uint32_t m_read32(const size_t& vPos) const {
+            return (vPos + 4U <= m_Size) ? (m_read16(vPos) | (m_read16(vPos + 2U) << 16U)) : 0U;
+        }
+        static bool m_isSameNoCase(const std::string& vA, const std::string& vB) {
+            if (vA.size() != vB.size()) {
+                return false;
+            }
+            for (size_t idx = 0U; idx < vA.size(); ++idx) {
+                if (tolower((unsigned char)vA[idx]) != tolower((unsigned char)vB[idx])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        static uint32_t m_crc32(const uint8_t* vData, const size_t& vSize) {
+            static const std::array<uint32_t, 256U> s_table = m_getCrc32Table();
+            uint32_t crc = 0xFFFFFFFFU;
+            for (size_t idx = 0U; idx < vSize; ++idx) {
+                crc = s_table[(crc ^ vData[idx]) & 0xFFU] ^ (crc >> 8U);
+            }
+            return ~crc;
+        }
+        static std::array<uint32_t, 256U> m_getCrc32Table() {
+            std::array<uint32_t, 256U> table;
+            for (uint32_t idx = 0U; idx < 256U; ++idx) {
+                uint32_t crc = idx;
+                for (uint32_t bit = 0U; bit < 8U; ++bit) {
+                    crc = (crc & 1U) ? (0xEDB88320U ^ (crc >> 1U)) : (crc >> 1U);
+                }
+                table[idx] = crc;
+            }
+            return table;
+        }
+    };
+
+    // cache file layout, in the native endianness :
+    // - the header
+    // - by model : component and surface names, smooth shading, material, vertices, uvs, indices and face sizes
+    // the strings and the arrays are an uint64 count followed by the raw items.
+    // the model and material names are made at the load, so they are unique in the converter
+    static const uint32_t s_CacheFormatVersion = 2U;
+    struct CacheHeader {
+        char magic[8];
+        uint32_t endian_tag;
+        uint32_t format_version;
+        char converter_version[16];
+        uint64_t key;
+        uint64_t source_size;
+        uint64_t models_count;
+        uint64_t parse_result;
+    };
+
+    // index file layout (file.mdlindex, next to the opened file), in the native endianness :
+    // - the header
+    // - by block : component, surface, begin, end, ended, vertices count, faces count, bounds and hash of the block text
+    // the bounds are valid only if have_bounds, when the index was written after the parse of all the blocks
+    static const uint32_t s_IndexFormatVersion = 1U;
+    struct IndexHeader {
+        char magic[8];
+        uint32_t endian_tag;
+        uint32_t format_version;
+        uint64_t mdl_size;  // size of the mdl text, once unzipped
+        uint64_t blocks_count;
+        uint64_t have_bounds;
+    };
+
+    // bounds checked reads in a cache or index file
+    class CacheReader {
+    private:
+        const char* m_Data = nullptr;
+        size_t m_Size = 0U;
+        size_t m_Pos = 0U;
+        bool m_Failed = false;
+
+    public:
+        CacheReader(const char* vData, const size_t& vSize) : m_Data(vData), m_Size(vSize) {
+        }
+        bool isFailed() const {
+            return m_Failed;
+        }
+        // all the bytes was read without error
+        bool isEnded() const {
+            return !m_Failed && m_Pos == m_Size;
+        }
+        template <typename T>
+        void read(T& vOutValue) {
+            m_readBytes(&vOutValue, sizeof(T), 1U);
+        }
+        void read(std::string& vOutStr) {
+            uint64_t count = 0U;
+            read(count);
+            if (m_check(count, 1U)) {
+                vOutStr.assign(m_Data + m_Pos, (size_t)count);
+                m_Pos += (size_t)count;
+            }
+        }
+        template <typename T>
+        void read(std::vector<T>& vOutItems) {
+            uint64_t count = 0U;
+            read(count);
+            if (m_check(count, sizeof(T))) {
+                vOutItems.resize((size_t)count);
+                m_readBytes(vOutItems.data(), sizeof(T), (size_t)count);
+            }
+        }
+
+    private:
+        bool m_check(const uint64_t& vCount, const size_t& vItemSize) {
+            m_Failed |= (vCount > (m_Size - m_Pos) / vItemSize);
+            return !m_Failed;
+        }
+        void m_readBytes(void* vOutData, const size_t& vItemSize, const size_t& vCount) {
+            if (m_check(vCount, vItemSize)) {
+                memcpy(vOutData, m_Data + m_Pos, vItemSize * vCount);
+                m_Pos += vItemSize * vCount;
+            }
+        }
+    };
+
+    struct WeldStats {
+        size_t vertices_removed = 0U;
+        size_t faces_removed = 0U;
+    };
+
+    // acmr is the average count of cache misses by triangle, atvr by vertex
+    struct VertexCacheStats {
+        size_t misses_before = 0U;
+        size_t misses_after = 0U;
+        size_t triangles_count = 0U;
+        size_t vertices_count = 0U;
+    };
+
+    // symmetric 4x4 matrix of the quadric error metric, sum of the squared distances to planes
+    struct Quadric {
+        double m[10] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};  // aa ab ac ad bb bc bd cc cd dd
+        void addPlane(const double& vA, const double& vB, const double& vC, const double& vD, const double& vWeight) {
+            const double p[4] = {vA, vB, vC, vD};
+            size_t idx = 0U;
+            for (size_t i = 0U; i < 4U; ++i) {
+                for (size_t j = i; j < 4U; ++j) {
+                    m[idx++] += p[i] * p[j] * vWeight;
+                }
+            }
+        }
+        void add(const Quadric& vOther) {
+            for (size_t idx = 0U; idx < 10U; ++idx) {
+                m[idx] += vOther.m[idx];
+            }
+        }
+        double getError(const Vertex& vPos) const {
+            const double x = vPos[0], y = vPos[1], z = vPos[2];
+            return m[0] * x * x + 2.0 * m[1] * x * y + 2.0 * m[2] * x * z + 2.0 * m[3] * x +  //
+                   m[4] * y * y + 2.0 * m[5] * y * z + 2.0 * m[6] * y +                       //
+                   m[7] * z * z + 2.0 * m[8] * z + m[9];
+        }
+    };
+
+    // collapse of the vertex from on the vertex to. the stamps are the versions of the vertices quadrics
+    // when the collapse was evaluated, the collapse is outdated if they changed
+    struct Collapse {
+        double cost = 0.0;
+        uint32_t from = 0U;
+        uint32_t to = 0U;
+        uint32_t from_stamp = 0U;
+        uint32_t to_stamp = 0U;
+        bool operator>(const Collapse& vOther) const {
+            return cost > vOther.cost;
+        }
+    };
+
+    // difference between the parsed values and the stored values of a model
+    struct PrecisionStats {
+        double vertices_error = 0.0;
+        double uvs_error = 0.0;
+    };
+
+    struct NormalsStats {
+        size_t normals_count = 0U;
+        size_t smooth_models = 0U;
+        size_t flat_models = 0U;
+    };
+
+    struct PassesStats {
+        WeldStats weld;
+        VertexCacheStats vertex_cache;
+        NormalsStats normals;
+        PrecisionStats precision;
+        void add(const WeldStats& vStats) {
+            weld.vertices_removed += vStats.vertices_removed;
+            weld.faces_removed += vStats.faces_removed;
+        }
+        void add(const VertexCacheStats& vStats) {
+            vertex_cache.misses_before += vStats.misses_before;
+            vertex_cache.misses_after += vStats.misses_after;
+            vertex_cache.triangles_count += vStats.triangles_count;
+            vertex_cache.vertices_count += vStats.vertices_count;
+        }
+        void add(const NormalsStats& vStats) {
+            normals.normals_count += vStats.normals_count;
+            normals.smooth_models += vStats.smooth_models;
+            normals.flat_models += vStats.flat_models;
+        }
+        void add(const PrecisionStats& vStats) {
+            precision.vertices_error = std::max(precision.vertices_error, vStats.vertices_error);
+            precision.uvs_error = std::max(precision.uvs_error, vStats.uvs_error);
+        }
+        void add(const PassesStats& vStats) {
+            add(vStats.weld);
+            add(vStats.vertex_cache);
+            add(vStats.normals);
+            add(vStats.precision);
+        }
+    };
+
+    // layout of a model in the binary chunk of a glb file
+    struct GlbMesh {
+        size_t model_idx = 0U;
+        size_t triangles_count = 0U;
+        bool have_uvs = false;
+        bool short_indices = false;
+        bool quantized = false;  // 16 bits positions (KHR_mesh_quantization), with the bounds in the node transform
+        bool have_normals = false;
+        size_t vertices_count = 0U;
+        size_t positions_offset = 0U;
+        size_t uvs_offset = 0U;
+        size_t normals_offset = 0U;
+        size_t indices_offset = 0U;
+        // with the normals, a glb vertex is a vertex of the model with one of its normals,
+        // and the triangles are made of the glb vertices
+        std::vector<uint32_t> vertex_ids;
+        std::vector<uint32_t> normal_ids;
+        std::vector<uint32_t> triangles;
+        float min[3];
+        float max[3];
+    };
+
+    // add the time of its life to vioSeconds
+    class PhaseTimer {
+    private:
+        double& m_Seconds;
+        std::chrono::steady_clock::time_point m_Start;
+
+    public:
+        explicit PhaseTimer(double& vioSeconds) : m_Seconds(vioSeconds), m_Start(std::chrono::steady_clock::now()) {
+        }
+        ~PhaseTimer() {
+            m_Seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - m_Start).count();
+        }
+    };
+
+public:
+    // None print nothing, Error the failures (on stderr), Info the results of the passes, Debug the parse details
+    enum class LogLevel { None = 0, Error, Info, Debug };
+
+    // measures of the calls of openMdlFile and of the save functions on this instance
+    struct Stats {
+        struct ModelStats {
+            std::string name;
+            size_t vertices = 0U;
+            size_t faces = 0U;
+        };
+        double load_seconds = 0.0;     // read of the file, unzip, cache hash
+        double parse_seconds = 0.0;    // parse of the mdl text, or load of the cache
+        double process_seconds = 0.0;  // weld, vertex cache, lods
+        double write_seconds = 0.0;    // save of the files and of the cache
+        uint64_t source_bytes = 0U;    // size of the opened files
+        uint64_t mdl_bytes = 0U;       // size of the parsed mdl texts, once unzipped
+        uint64_t written_bytes = 0U;
+        uint64_t allocations = 0U;     // count of allocations, if the application count them (see getAllocationsCounter)
+        uint64_t peak_rss = 0U;        // peak resident memory of the process in bytes, 0 if unknown
+        double vertices_error = 0.0;   // max difference between the parsed and the stored positions, see setPrecision
+        double uvs_error = 0.0;        // same for the uvs
+        uint64_t draw_calls_before = 0U;  // count of models parsed, one draw call each
+        uint64_t draw_calls_after = 0U;   // count of models saved, less than before with setMergeModels
+        std::vector<ModelStats> models;
+    };
+
+    // the application can increment this counter in its operator new (see main.cpp), the stats then give the
+    // count of allocations. the counter is for the process, so the count include the other threads allocations
+    static std::atomic<uint64_t>& getAllocationsCounter() {
+        static std::atomic<uint64_t> s_counter(0U);
+        return s_counter;
+    }
+
+    // the best scan kernel supported by the build and the cpu
+    static ScanLevel getBestScanLevel() {
+        if (m_isAVX2Supported()) {
+            return ScanLevel::AVX2;
+        }
+#if defined(MDL_TO_OBJ_USE_SSE2)
+        return ScanLevel::SSE2;
+#else
+        return ScanLevel::Scalar;
+#endif
+    }
+
+    // the scan kernel is the best one by default, another one can be forced for compare them.
+    // the kernel is for the process, and used by the next parses. return false if not supported
+    static bool setScanLevel(const ScanLevel& vLevel) {
+        if (vLevel > getBestScanLevel()) {
+            return false;
+        }
+        m_getScanLevelRef().store(vLevel);
+        return true;
+    }
+
+    static ScanLevel getScanLevel() {
+        return m_getScanLevelRef().load();
+    }
+
+    // scan vData like the parse do it, with the current kernel.
+    // vOutLineEnds receive the offsets of the line endings, vOutTokens the begin and end offsets of the tokens
+    static void scanText(const char* vData, const size_t& vSize, std::vector<size_t>& vOutLineEnds, std::vector<size_t>& vOutTokens) {
+        vOutLineEnds.clear();
+        vOutTokens.clear();
+        LineLexer lexer(vData, vSize);
+        StrView line;
+        std::vector<StrView> tokens;
+        while (lexer.next(line, &tokens)) {
+            vOutLineEnds.push_back(static_cast<size_t>(line.ptr + line.size - vData));
+            for (const auto& token : tokens) {
+                vOutTokens.push_back(static_cast<size_t>(token.ptr - vData));
+                vOutTokens.push_back(static_cast<size_t>(token.ptr + token.size - vData));
+            }
+        }
+    }
+
+private:
+    std::vector<Model> m_Models;
+    std::string m_SourceFilePathName;
+    std::set<std::string> m_Components;
+    bool m_UseMemoryMapping = true;
+    uint32_t m_ThreadsCount = 0U;
+    bool m_ExtractTextures = false;
+    std::string m_CacheDirectory;
+    double m_WeldEpsilon = -1.0;
+    uint32_t m_VertexCacheSize = 0U;
+    bool m_OptimizeOverdraw = false;
+    bool m_ComputeNormals = false;
+    double m_CreaseAngle = 180.0;
+    bool m_MergeModels = false;
+    std::vector<double> m_LodRatios;
+    std::vector<std::vector<Model>> m_Lods;  // by level, one model by model of m_Models
+    Arena m_Arena;
+    bool m_UseIndex = false;
+    std::string m_IndexFilePathName;  // index of the file being opened, empty if not used
+    std::vector<std::string> m_ComponentFilter;
+    Precision m_Precision = Precision::Double;
+    LogLevel m_LogLevel = LogLevel::Error;
+    Stats m_Stats;
+
+public:
+    // the mdl file is memory mapped by default, if false he is read in memory
+    void setUseMemoryMapping(const bool& vUseMemoryMapping) {
+        m_UseMemoryMapping = vUseMemoryMapping;
+    }
+
+    // count of threads used for parse and write, 0 for the count of cores
+    void setThreadsCount(const uint32_t& vThreadsCount) {
+        m_ThreadsCount = vThreadsCount;
+    }
+
+    // the referenced textures (FRGB) are extracted next to the obj file, when the mdl file come from a zip file
+    void setExtractTextures(const bool& vExtractTextures) {
+        m_ExtractTextures = vExtractTextures;
+    }
+
+    // the parsed models are saved in this directory, and loaded from it when the same file is opened again.
+    // empty for no cache (default)
+    void setCacheDirectory(const std::string& vCacheDirectory) {
+        m_CacheDirectory = vCacheDirectory;
+    }
+
+    // a sidecar index file (file.mdlindex, next to the opened file) keep the offsets, counts and bounds of the meshes.
+    // he is made at the first open of the file, then the next opens find the meshes without scan the file. false by default
+    void setUseIndex(const bool& vUseIndex) {
+        m_UseIndex = vUseIndex;
+    }
+
+    // only the meshes whose component or model name match one of the patterns (* and ? wildcards) are parsed and saved.
+    // with the index, the other meshes are not even read. the cache is not used with a filter. empty for all (default)
+    void setComponentFilter(const std::vector<std::string>& vPatterns) {
+        m_ComponentFilter = vPatterns;
+    }
+
+    // the vertices of a model closer than vEpsilon (position and uv) are merged, and the degenerated faces removed.
+    // 0 merge only the same vertices, negative for no welding (default)
+    void setWeldEpsilon(const double& vEpsilon) {
+        m_WeldEpsilon = vEpsilon;
+    }
+
+    // the triangles are reordered for a post transform vertex cache of vCacheSize entries (16 is a good choice),
+    // then the vertices in the order of first use. 0 for keep the file order (default)
+    void setVertexCacheSize(const uint32_t& vCacheSize) {
+        m_VertexCacheSize = vCacheSize;
+    }
+
+    // after the vertex cache optimization, the clusters of triangles are sorted from the outside to the inside
+    // of the model, for reduce the overdraw
+    void setOptimizeOverdraw(const bool& vOptimizeOverdraw) {
+        m_OptimizeOverdraw = vOptimizeOverdraw;
+    }
+
+    // the normals of the models are computed and saved (vn in the obj files, NORMAL in the glb files) :
+    // smoothed normals for the smooth shaded models, one normal by face for the others. false by default
+    void setComputeNormals(const bool& vComputeNormals) {
+        m_ComputeNormals = vComputeNormals;
+    }
+
+    // the faces of a smooth shaded model who form an angle bigger than vDegrees are not smoothed
+    // together, so the edge stay sharp. 180 for smooth all the faces (default)
+    void setCreaseAngle(const double& vDegrees) {
+        m_CreaseAngle = vDegrees;
+    }
+
+    // the identical materials are saved once, and the models with the same material and shading are merged in one model,
+    // for less draw calls. Model::parts keep the names and the ranges of the merged models. false by default
+    void setMergeModels(const bool& vMergeModels) {
+        m_MergeModels = vMergeModels;
+    }
+
+    // a simplified model is made for each ratio of the triangles count, ex : {0.5, 0.25, 0.1}.
+    // saveObjFile and saveGlbFile save them in file_lod1.obj/.glb, file_lod2.obj/.glb.. empty for no lods (default)
+    void setLodRatios(const std::vector<double>& vLodRatios) {
+        m_LodRatios = vLodRatios;
+    }
+
+    // storage of the vertices and uvs of the models once parsed and processed :
+    // double (default), float, or 16 bits integers relative to the bounds of each model.
+    // the difference with the parsed values is given by the stats
+    void setPrecision(const Precision& vPrecision) {
+        m_Precision = vPrecision;
+    }
+
+    // quiet by default, only the errors are printed
+    void setLogLevel(const LogLevel& vLogLevel) {
+        m_LogLevel = vLogLevel;
+    }
+
+    const Stats& getStats() const {
+        return m_Stats;
+    }
+
+    // the stats in a json object
+    std::string getStatsJson() const {
+        const auto& st = m_Stats;
+        std::string json = "{\"load_seconds\":" + m_getJsonNumber(st.load_seconds) + ",\"parse_seconds\":" + m_getJsonNumber(st.parse_seconds) +
+                           ",\"process_seconds\":" + m_getJsonNumber(st.process_seconds) +
+                           ",\"write_seconds\":" + m_getJsonNumber(st.write_seconds) + ",\"source_bytes\":" + std::to_string(st.source_bytes) +
+                           ",\"mdl_bytes\":" + std::to_string(st.mdl_bytes) + ",\"written_bytes\":" + std::to_string(st.written_bytes) +
+                           ",\"allocations\":" + std::to_string(st.allocations) + ",\"peak_rss\":" + std::to_string(st.peak_rss) +
+                           ",\"vertices_error\":" + m_getJsonNumber(st.vertices_error) + ",\"uvs_error\":" + m_getJsonNumber(st.uvs_error) +
+                           ",\"draw_calls_before\":" + std::to_string(st.draw_calls_before) +
+                           ",\"draw_calls_after\":" + std::to_string(st.draw_calls_after) + ",\"models\":[";
+        for (size_t idx = 0U; idx < st.models.size(); ++idx) {
+            const auto& model = st.models[idx];
+            json += std::string(idx ? "," : "") + "{\"name\":" + m_getJsonString(model.name) + ",\"vertices\":" + std::to_string(model.vertices) +
+                    ",\"faces\":" + std::to_string(model.faces) + "}";
+        }
+        return json + "]}";
+    }
+
+    // the models parsed by the previous calls of openMdlFile
+    const std::vector<Model>& getModels() const {
+        return m_Models;
+    }
+
+    // forget the opened files (models, lods, names and stats) for convert other files with the same options.
+    // the arrays of the models and of the parse keep their capacity, so a converter reused for files of similar
+    // sizes allocate almost nothing after the first file (see Stats::allocations). the memory is freed by the destructor
+    void reset() {
+        m_releaseModels(m_Models, 0U);
+        for (auto& lods : m_Lods) {
+            m_releaseModels(lods, 0U);
+        }
+        m_Lods.clear();
+        m_Components.clear();
+        m_SourceFilePathName.clear();
+        auto models_stats = std::move(m_Stats.models);
+        models_stats.clear();
+        m_Stats = Stats();
+        m_Stats.models = std::move(models_stats);
+    }
+
+    // vFile can be a mdl file, or a zip file containing a mdl file (stored or deflated)
+    bool openMdlFile(const std::string& vFile) {
+        const auto allocations = getAllocationsCounter().load();
+        InputFile source;
+        bool opened = false;
+        {
+            PhaseTimer timer(m_Stats.load_seconds);
+            opened = source.open(vFile, m_UseMemoryMapping);
+        }
+        bool res = false;
+        if (opened) {
+            m_IndexFilePathName = m_UseIndex ? m_getIndexFilePathName(vFile) : std::string();
+            res = m_openSource(vFile, source.data(), source.size());
+            m_IndexFilePathName.clear();
+        } else {
+            m_log(LogLevel::Error, "Fail to open the file ", vFile);
+        }
+        m_updateStats(allocations);
+        return res;
+    }
+
+    // same as openMdlFile, for a file already in memory. vName replace the file name in the logs,
+    // and give the default name of the saved files
+    bool openMdlBuffer(const char* vData, const size_t& vSize, const std::string& vName = "memory.mdl") {
+        const auto allocations = getAllocationsCounter().load();
+        const bool res = m_openSource(vName, vData, vSize);
+        m_updateStats(allocations);
+        return res;
+    }
+
+    // same as openMdlFile, for a file read by chunks : vReader fill the buffer and return the count of bytes given, 0 at the end.
+    // the chunks are gathered in memory before the parse, since the blocks are parsed in parallel
+    bool openMdlReader(const std::function<size_t(char*, size_t)>& vReader, const std::string& vName = "memory.mdl") {
+        std::vector<char> buffer;
+        {
+            PhaseTimer timer(m_Stats.load_seconds);
+            const size_t chunk_size = 1024U * 1024U;
+            size_t size = 0U;
+            for (;;) {
+                buffer.resize(size + chunk_size);
+                const size_t count = std::min(vReader(buffer.data() + size, chunk_size), chunk_size);
+                if (!count) {
+                    break;
+                }
+                size += count;
+            }
+            buffer.resize(size);
+        }
+        return openMdlBuffer(buffer.data(), buffer.size(), vName);
+    }
+
+    bool saveObjFile(const std::string& vFile) {
+        const auto allocations = getAllocationsCounter().load();
+        bool res = m_saveObjFile(vFile);
+        m_updateStats(allocations);
+        return res;
+    }
+
+    // same as saveObjFile, but the texts are given to the sinks instead of files.
+    // the obj text reference the mtl file vMtlFileName. the lods and the textures are not saved
+    bool saveObjToSinks(OutputSink& vObjSink, OutputSink& vMtlSink, const std::string& vMtlFileName) {
+        const auto allocations = getAllocationsCounter().load();
+        bool res = false;
+        {
+            PhaseTimer timer(m_Stats.write_seconds);
+            TextWriter writer;
+            writer.open(vMtlSink);
+            m_writeMtl(writer, m_Models);
+            res = writer.close();
+            m_Stats.written_bytes += writer.getWrittenSize();
+            writer.open(vObjSink);
+            m_writeObj(writer, m_Models, vMtlFileName);
+            res &= writer.close();
+            m_Stats.written_bytes += writer.getWrittenSize();
+        }
+        if (!res) {
+            m_log(LogLevel::Error, "Fail to write the obj or mtl text of ", m_SourceFilePathName);
+        }
+        m_updateStats(allocations);
+        return res;
+    }
+
+    // binary glTF 2.0 file, one mesh per model.
+    // float32 positions and uvs, uint16 indices when the model have less than 65535 vertices, else uint32.
+    // the lods are saved in file_lod1.glb, file_lod2.glb..
+    bool saveGlbFile(const std::string& vFile) {
+        const auto allocations = getAllocationsCounter().load();
+        bool res = m_saveGlbFile(vFile);
+        m_updateStats(allocations);
+        return res;
+    }
+
+    // streaming conversion of vFile in the obj/mtl files of vObjFile (the source name if empty).
+    // the meshes are written as soon as they are parsed, then released, so the memory is bounded
+    // by the biggest meshes parsed at the same time, not by the whole file.
+    // the models are not kept, so the lods, the cache and the merge are not used
+    bool convertMdlFile(const std::string& vFile, const std::string& vObjFile) {
+        const auto allocations = getAllocationsCounter().load();
+        m_IndexFilePathName = m_UseIndex ? m_getIndexFilePathName(vFile) : std::string();
+        bool res = m_convertMdlFile(vFile, vObjFile);
+        m_IndexFilePathName.clear();
+        m_updateStats(allocations);
+        return res;
+    }
+
+private:
+    bool m_saveObjFile(const std::string& vFile) {
+        PhaseTimer timer(m_Stats.write_seconds);
+        bool res = false;
+        std::string filePathNames[2];  // 0: obj file, 1: mtl file
+        if (vFile.empty()) {
+            filePathNames[0] = m_replaceFileNameExt(m_SourceFilePathName, ".obj");
+            filePathNames[1] = m_replaceFileNameExt(m_SourceFilePathName, ".mtl");
+        } else {
+            filePathNames[0] = m_replaceFileNameExt(vFile, ".obj");
+            filePathNames[1] = m_replaceFileNameExt(vFile, ".mtl");
+        }
+
+        ///////////////////////////////////
+        //// write mtl file ///////////////
+        ///////////////////////////////////
+
+        TextWriter writer;
+        if (writer.open(filePathNames[1])) {
+            m_writeMtl(writer, m_Models);
+            res = writer.close();
+            m_Stats.written_bytes += writer.getWrittenSize();
+        } else {
+            m_log(LogLevel::Error, "Fail to save the file ", filePathNames[1]);
+        }
+
+        ///////////////////////////////////
+        //// write obj file ///////////////
+        ///////////////////////////////////
+
+        const auto mtl_file_name = m_getFileName(filePathNames[1]);
+        res &= m_writeObjFile(filePathNames[0], m_Models, mtl_file_name);
+
+        // the lods are saved in file_lod1.obj, file_lod2.obj.. and use the same mtl file
+        for (size_t level = 0U; level < m_Lods.size(); ++level) {
+            res &= m_writeObjFile(m_replaceFileNameExt(filePathNames[0], "_lod" + std::to_string(level + 1U) + ".obj"), m_Lods[level], mtl_file_name);
+        }
+
+        if (m_ExtractTextures) {
+            const auto& obj_file = filePathNames[0];
+            m_extractTextures(obj_file.substr(0U, obj_file.size() - m_getFileName(obj_file).size()), m_getTextures());
+        }
+
+        return res;
+    }
+
+    bool m_convertMdlFile(const std::string& vFile, const std::string& vObjFile) {
+        InputFile source;
+        bool opened = false;
+        {
+            PhaseTimer timer(m_Stats.load_seconds);
+            opened = source.open(vFile, m_UseMemoryMapping);
+        }
+        if (!opened) {
+            m_log(LogLevel::Error, "Fail to open the file ", vFile);
+            return false;
+        }
+        m_SourceFilePathName = vFile;
+        m_Stats.source_bytes += source.size();
+
+        // a zip entry is inflated in memory, a mdl file is mapped
+        std::vector<char> buffer;
+        const char* data = source.data();
+        size_t size = source.size();
+        if (ZipArchive::isZip(source.data(), source.size()) && !m_unzipMdl(source.data(), source.size(), buffer, data, size)) {
+            return false;
+        }
+
+        std::string filePathNames[2];  // 0: obj file, 1: mtl file
+        filePathNames[0] = m_replaceFileNameExt(vObjFile.empty() ? vFile : vObjFile, ".obj");
+        filePathNames[1] = m_replaceFileNameExt(vObjFile.empty() ? vFile : vObjFile, ".mtl");
+        TextWriter obj_writer;
+        TextWriter mtl_writer;
+        for (size_t idx = 0U; idx < 2U; ++idx) {
+            if (!(idx ? mtl_writer : obj_writer).open(filePathNames[idx])) {
+                m_log(LogLevel::Error, "Fail to save the file ", filePathNames[idx]);
+                return false;
+            }
+        }
+        obj_writer.write(u8R"(# OBJ File generated with MdlToObj from a STK/MDL file
+# MdlToObj : https://github.com/aiekick/MdlToObj
+)");
+        mtl_writer.write(u8R"(# MTL File generated with MdlToObj from a STK/MDL file
+# MdlToObj : https://github.com/aiekick/MdlToObj
+)");
+        const auto mtl_file_name = m_getFileName(filePathNames[1]);
+
+        std::vector<MeshBlock> blocks;
+        std::vector<size_t> selected;
+        bool save_index = false;
+        {
+            PhaseTimer timer(m_Stats.parse_seconds);
+            m_Stats.mdl_bytes += size;
+            save_index = m_getMeshBlocks(data, size, blocks, selected);
+        }
+        const bool have_bounds = (save_index && selected.size() == blocks.size());
+
+        // the blocks are parsed, processed and formatted by windows of one block per thread,
+        // then written in order. the vertices and uvs offsets are carried from a window to the next
+        const size_t window_size = std::max<size_t>(m_getThreadsCount(), 1U);
+        std::vector<Model> models(window_size);
+        std::vector<MeshBuffers> buffers(window_size);
+        std::vector<PassesStats> stats(window_size);
+        std::vector<TextWriter> model_writers;
+        for (size_t idx = 0U; idx < window_size; ++idx) {
+            model_writers.emplace_back(0U);
+        }
+        std::vector<uint32_t> vertices_offsets(window_size);
+        std::vector<uint32_t> uvs_offsets(window_size);
+        std::vector<uint32_t> normals_offsets(window_size);
+        uint32_t vertices_offset = 0U;
+        uint32_t uvs_offset = 0U;
+        uint32_t normals_offset = 0U;
+        PassesStats total;
+        std::set<std::string> textures;
+        bool res = false;
+        for (size_t first = 0U; first < selected.size(); first += window_size) {
+            const size_t count = std::min(window_size, selected.size() - first);
+            {
+                PhaseTimer timer(m_Stats.parse_seconds);
+                m_parallelFor(count, [&](const size_t& vIdx) {
+                    auto& block = blocks[selected[first + vIdx]];
+                    m_parseMeshBlock(data, block, models[vIdx], buffers[vIdx]);
+                    if (have_bounds) {
+                        m_getBounds(models[vIdx], block);
+                    }
+                });
+            }
+            if (m_WeldEpsilon >= 0.0 || m_VertexCacheSize || m_ComputeNormals || m_Precision != Precision::Double) {
+                PhaseTimer timer(m_Stats.process_seconds);
+                m_parallelFor(count, [&](const size_t& vIdx) {
+                    m_processModel(models[vIdx], stats[vIdx], 1U);
+                    stats[vIdx].add(m_compactModel(models[vIdx], m_Precision));
+                });
+            }
+            // like m_parseMdl, the result is given by the last mesh
+            const auto& last = models[count - 1U];
+            res = (last.getVerticesCount() && !last.indices.empty());
+            PhaseTimer timer(m_Stats.write_seconds);
+            for (size_t idx = 0U; idx < count; ++idx) {
+                if (blocks[selected[first + idx]].ended) {
+                    vertices_offsets[idx] = vertices_offset;
+                    uvs_offsets[idx] = uvs_offset;
+                    normals_offsets[idx] = normals_offset;
+                    vertices_offset += (uint32_t)models[idx].getVerticesCount();
+                    uvs_offset += (uint32_t)models[idx].getUVsCount();
+                    normals_offset += (uint32_t)models[idx].normals.size();
+                }
+            }
+            m_parallelFor(count, [&](const size_t& vIdx) {
+                auto& model_writer = model_writers[vIdx];
+                model_writer.clear();
+                if (blocks[selected[first + vIdx]].ended) {
+                    m_writeObjModel(model_writer, models[vIdx], mtl_file_name, vertices_offsets[vIdx], uvs_offsets[vIdx], normals_offsets[vIdx]);
+                }
+            });
+            obj_writer.writeTexts(model_writers.data(), count);
+            for (size_t idx = 0U; idx < count; ++idx) {
+                auto& model = models[idx];
+                if (blocks[selected[first + idx]].ended) {
+                    m_writeObjMaterial(mtl_writer, model.mat);
+                    m_addTexture(model, textures);
+                    Stats::ModelStats model_stats;
+                    model_stats.name = model.name;
+                    model_stats.vertices = model.getVerticesCount();
+                    model_stats.faces = model.getFacesCount();
+                    m_Stats.models.push_back(model_stats);
+                    ++m_Stats.draw_calls_before;
+                    ++m_Stats.draw_calls_after;
+                }
+                total.add(stats[idx]);
+                stats[idx] = PassesStats();
+                model = Model();  // release the buffers of the mesh
+            }
+        }
+        m_logPassesStats(total);
+        if (m_Precision != Precision::Double) {
+            m_addPrecisionStats(std::vector<PrecisionStats>(1U, total.precision));
+        }
+
+        PhaseTimer timer(m_Stats.write_seconds);
+        if (save_index) {
+            m_saveIndex(data, size, blocks, have_bounds);
+        }
+        for (size_t idx = 0U; idx < 2U; ++idx) {
+            auto& writer = idx ? mtl_writer : obj_writer;
+            if (!writer.close()) {
+                m_log(LogLevel::Error, "Fail to save the file ", filePathNames[idx]);
+                res = false;
+            }
+            m_Stats.written_bytes += writer.getWrittenSize();
+        }
+        if (m_ExtractTextures) {
+            const auto& obj_file = filePathNames[0];
+            m_extractTextures(obj_file.substr(0U, obj_file.size() - m_getFileName(obj_file).size()), textures);
+        }
+        return res;
+    }
+
+    bool m_saveGlbFile(const std::string& vFile) {
+        PhaseTimer timer(m_Stats.write_seconds);
+        const auto file_path_name = m_replaceFileNameExt(vFile.empty() ? m_SourceFilePathName : vFile, ".glb");
+        bool res = m_writeGlbFile(file_path_name, m_Models);
+
+        // the lods are saved in file_lod1.glb, file_lod2.glb..
+        for (size_t level = 0U; level < m_Lods.size(); ++level) {
+            res &= m_writeGlbFile(m_replaceFileNameExt(file_path_name, "_lod" + std::to_string(level + 1U) + ".glb"), m_Lods[level]);
+        }
+
+        if (m_ExtractTextures) {
+            m_extractTextures(file_path_name.substr(0U, file_path_name.size() - m_getFileName(file_path_name).size()), m_getTextures());
+        }
+
+        return res;
+    }
+    bool m_writeGlbFile(const std::string& vFilePathName, const std::vector<Model>& vModels) {
+        // layout of the binary chunk, one buffer view by attribute
+        std::vector<GlbMesh> meshes;
+        size_t bin_size = 0U;
+        for (size_t idx = 0U; idx < vModels.size(); ++idx) {
+            const auto& model = vModels[idx];
+            GlbMesh mesh;
+            mesh.model_idx = idx;
+            m_forEachTriangle(model, [&mesh](const uint32_t&, const uint32_t&, const uint32_t&) { ++mesh.triangles_count; });
+            if (!mesh.triangles_count) {
+                continue;
+            }
+            mesh.have_uvs = (model.getUVsCount() == model.getVerticesCount());
+            mesh.have_normals = !model.normals.empty();
+            mesh.vertices_count = model.getVerticesCount();
+            if (mesh.have_normals) {
+                std::unordered_map<uint64_t, uint32_t> glb_ids;
+                mesh.triangles.reserve(mesh.triangles_count * 3U);
+                m_forEachTriangleItems(model, [&](const uint32_t* vIds, const size_t* vItems) {
+                    for (size_t c = 0U; c < 3U; ++c) {
+                        const auto normal_id = model.normal_indices[vItems[c]];
+                        const auto it = glb_ids.emplace(((uint64_t)vIds[c] << 32U) | normal_id, (uint32_t)mesh.vertex_ids.size());
+                        if (it.second) {
+                            mesh.vertex_ids.push_back(vIds[c]);
+                            mesh.normal_ids.push_back(normal_id);
+                        }
+                        mesh.triangles.push_back(it.first->second);
+                    }
+                });
+                mesh.vertices_count = mesh.vertex_ids.size();
+            }
+            const auto vertices_count = mesh.vertices_count;
+            mesh.short_indices = (vertices_count < 0xFFFFU);  // 0xFFFF is the primitive restart value
+            mesh.quantized = (model.precision == Precision::Quantized16);
+            mesh.positions_offset = bin_size;
+            bin_size += vertices_count * m_getGlbPositionSize(mesh);
+            mesh.uvs_offset = bin_size;
+            if (mesh.have_uvs) {
+                bin_size += vertices_count * 2U * sizeof(float);
+            }
+            mesh.normals_offset = bin_size;
+            if (mesh.have_normals) {
+                bin_size += vertices_count * 3U * sizeof(float);
+            }
+            mesh.indices_offset = bin_size;
+            bin_size += m_getGlbIndicesSize(mesh);
+            bin_size = (bin_size + 3U) & ~(size_t)3U;  // each buffer view start on 4 bytes
+            for (size_t c = 0U; c < 3U; ++c) {
+                mesh.min[c] = std::numeric_limits<float>::max();
+                mesh.max[c] = -std::numeric_limits<float>::max();
+            }
+            for (size_t v = 0U; v < vertices_count; ++v) {
+                const auto id = m_getGlbVertexId(mesh, v);
+                for (size_t c = 0U; c < 3U; ++c) {
+                    // the bounds of the quantized positions are in the quantized space
+                    const float value = mesh.quantized ? (float)model.vertices_q16[id][c] : (float)model.getVertex(id)[c];
+                    mesh.min[c] = std::min(mesh.min[c], value);
+                    mesh.max[c] = std::max(mesh.max[c], value);
+                }
+            }
+            meshes.push_back(mesh);
+        }
+        if ((uint64_t)bin_size > 0xFFFFFFFFULL - 1024U) {
+            m_log(LogLevel::Error, "The model is too big for a glb file");
+            return false;
+        }
+
+        std::string json = m_getGlbJson(vModels, meshes, bin_size);
+        while (json.size() % 4U) {
+            json += ' ';
+        }
+
+        TextWriter writer;
+        if (!writer.open(vFilePathName, true)) {
+            m_log(LogLevel::Error, "Fail to save the file ", vFilePathName);
+            return false;
+        }
+        const uint32_t total_size = (uint32_t)(12U + 8U + json.size() + (bin_size ? 8U + bin_size : 0U));
+        m_writeUInt32LE(writer, 0x46546C67U);  // glTF
+        m_writeUInt32LE(writer, 2U);
+        m_writeUInt32LE(writer, total_size);
+        m_writeUInt32LE(writer, (uint32_t)json.size());
+        m_writeUInt32LE(writer, 0x4E4F534AU);  // JSON
+        writer.write(json);
+        if (bin_size) {
+            m_writeUInt32LE(writer, (uint32_t)bin_size);
+            m_writeUInt32LE(writer, 0x004E4942U);  // BIN
+            for (const auto& mesh : meshes) {
+                const auto& model = vModels[mesh.model_idx];
+                const auto vertices_count = mesh.vertices_count;
+                for (size_t v = 0U; v < vertices_count; ++v) {
+                    if (mesh.quantized) {
+                        const auto& q = model.vertices_q16[m_getGlbVertexId(mesh, v)];
+                        m_writeUInt16LE(writer, q[0]);
+                        m_writeUInt16LE(writer, q[1]);
+                        m_writeUInt16LE(writer, q[2]);
+                        m_writeUInt16LE(writer, 0U);  // the vertex attributes are aligned on 4 bytes
+                    } else {
+                        const auto vertex = model.getVertex(m_getGlbVertexId(mesh, v));
+                        m_writeFloat32LE(writer, vertex[0]);
+                        m_writeFloat32LE(writer, vertex[1]);
+                        m_writeFloat32LE(writer, vertex[2]);
+                    }
+                }
+                if (mesh.have_uvs) {
+                    for (size_t v = 0U; v < vertices_count; ++v) {
+                        const auto uv = model.getUV(m_getGlbVertexId(mesh, v));
+                        m_writeFloat32LE(writer, uv[0]);
+                        m_writeFloat32LE(writer, 1.0 - uv[1]);  // the glTF uv origin is the top left corner
+                    }
+                }
+                if (mesh.have_normals) {
+                    for (const auto& normal_id : mesh.normal_ids) {
+                        auto normal = model.normals[normal_id];
+                        if (mesh.quantized) {
+                            // the viewer applies the inverse of the node scale to the normals, so they are stored
+                            // scaled by the quantization steps for giving back the parsed normals
+                            const double x = normal[0] * model.vertices_step[0];
+                            const double y = normal[1] * model.vertices_step[1];
+                            const double z = normal[2] * model.vertices_step[2];
+                            const double len = std::sqrt(x * x + y * y + z * z);
+                            if (len > 0.0) {
+                                normal = m_getNormal(x / len, y / len, z / len);
+                            }
+                        }
+                        m_writeFloat32LE(writer, normal[0]);
+                        m_writeFloat32LE(writer, normal[1]);
+                        m_writeFloat32LE(writer, normal[2]);
+                    }
+                }
+                auto write_triangle = [&writer, &mesh](const uint32_t& vIdx0, const uint32_t& vIdx1, const uint32_t& vIdx2) {
+                    if (mesh.short_indices) {
+                        m_writeUInt16LE(writer, (uint16_t)vIdx0);
+                        m_writeUInt16LE(writer, (uint16_t)vIdx1);
+                        m_writeUInt16LE(writer, (uint16_t)vIdx2);
+                    } else {
+                        m_writeUInt32LE(writer, vIdx0);
+                        m_writeUInt32LE(writer, vIdx1);
+                        m_writeUInt32LE(writer, vIdx2);
+                    }
+                };
+                if (mesh.have_normals) {
+                    for (size_t idx = 0U; idx + 2U < mesh.triangles.size(); idx += 3U) {
+                        write_triangle(mesh.triangles[idx], mesh.triangles[idx + 1U], mesh.triangles[idx + 2U]);
+                    }
+                } else {
+                    m_forEachTriangle(model, write_triangle);
+                }
+                const auto end = mesh.indices_offset + m_getGlbIndicesSize(mesh);
+                for (size_t pad = end; pad % 4U; ++pad) {
+                    writer.write('\0');
+                }
+            }
+        }
+        bool res = writer.close();
+        m_Stats.written_bytes += writer.getWrittenSize();
+        if (!res) {
+            m_log(LogLevel::Error, "Fail to save the file ", vFilePathName);
+        }
+        return res;
+    }
+    void m_updateStats(const uint64_t& vAllocationsAtStart) {
+        m_Stats.allocations += getAllocationsCounter().load() - vAllocationsAtStart;
+        m_Stats.peak_rss = m_getPeakRss();
+    }
+    static uint64_t m_getPeakRss() {
+#if defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS counters;
+        if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+            return (uint64_t)counters.PeakWorkingSetSize;
+        }
+#elif defined(__unix__) || defined(__APPLE__)
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(__APPLE__)
+            return (uint64_t)usage.ru_maxrss;  // bytes
+#else
+            return (uint64_t)usage.ru_maxrss * 1024U;  // kilobytes
+#endif
+        }
+#endif
+        return 0U;
+    }
+    template <typename... TArgs>
+    void m_log(const LogLevel& vLevel, const TArgs&... vArgs) const {
+        if (vLevel != LogLevel::None && vLevel <= m_LogLevel) {
+            // the line is made before the print, so the lines of parallel conversions are not mixed
+            std::ostringstream line;
+            m_appendToLog(line, vArgs...);
+            line << '\n';
+            (vLevel == LogLevel::Error ? std::cerr : std::cout) << line.str();
+        }
+    }
+    static void m_appendToLog(std::ostringstream& /*vLine*/) {
+    }
+    template <typename T, typename... TArgs>
+    static void m_appendToLog(std::ostringstream& vLine, const T& vValue, const TArgs&... vArgs) {
+        vLine << vValue;
+        m_appendToLog(vLine, vArgs...);
+    }
+    static std::string m_replaceFileNameExt(const std::string& vFilePathName, const std::string& vNewExt) {
+        assert(!vFilePathName.empty());
+        auto lastDot = vFilePathName.find_last_of('.');
+        if (lastDot == std::string::npos) {
+            return vFilePathName;
+        }
+        auto pathWithoutExtension = vFilePathName.substr(0, lastDot);
+        return pathWithoutExtension + vNewExt;
+    }
+    // file.mdlindex next to the opened file
+    static std::string m_getIndexFilePathName(const std::string& vFile) {
+        const auto last_slash = vFile.find_last_of("/\\");
+        const auto last_dot = vFile.find_last_of('.');
+        if (last_dot == std::string::npos || (last_slash != std::string::npos && last_dot < last_slash)) {
+            return vFile + ".mdlindex";
+        }
+        return vFile.substr(0U, last_dot) + ".mdlindex";
+    }
+    // temporary name of vFile before its rename, unique between the converters of the process
+    // and between the processes, which can write the same cache or index file at the same time
+    static std::string m_getTempFilePathName(const std::string& vFile) {
+        static std::atomic<uint64_t> s_counter(0U);
+#if defined(_WIN32)
+        const unsigned long pid = (unsigned long)GetCurrentProcessId();
+#elif defined(__unix__) || defined(__APPLE__)
+        const unsigned long pid = (unsigned long)getpid();
+#else
+        const unsigned long pid = 0U;
+#endif
+        char suffix[64];
+        snprintf(suffix, sizeof(suffix), ".%lu.%llu.tmp", pid, (unsigned long long)s_counter.fetch_add(1U));
+        return vFile + suffix;
+    }
+    static std::string m_getFileName(const std::string& vFilePathName) {
+        assert(!vFilePathName.empty());
+        auto lastSlash = vFilePathName.find_last_of("/\\");
+        if (lastSlash == std::string::npos) {
+            return vFilePathName;
+        }
+        return vFilePathName.substr(lastSlash + 1);
+    }
+    bool m_writeObjFile(const std::string& vObjFile, const std::vector<Model>& vModels, const std::string& vMtlFileName) {
+        TextWriter writer;
+        if (writer.open(vObjFile)) {
+            m_writeObj(writer, vModels, vMtlFileName);
+            const bool closed = writer.close();
+            m_Stats.written_bytes += writer.getWrittenSize();
+            if (closed) {
+                return true;
+            }
+        }
+        m_log(LogLevel::Error, "Fail to save the file ", vObjFile);
+        return false;
+    }
+    void m_writeMtl(TextWriter& vWriter, const std::vector<Model>& vModels) const {
+        vWriter.write(u8R"(# MTL File generated with MdlToObj from a STK/MDL file
+# MdlToObj : https://github.com/aiekick/MdlToObj
+)");
+        std::set<std::string> written;  // the merged materials are shared by several models
+        for (const auto& model : vModels) {
+            if (!m_MergeModels || written.insert(model.mat.name).second) {
+                m_writeObjMaterial(vWriter, model.mat);
+            }
+        }
+    }
+    void m_writeObj(TextWriter& vWriter, const std::vector<Model>& vModels, const std::string& vMtlFileName) const {
+        vWriter.write(u8R"(# OBJ File generated with MdlToObj from a STK/MDL file
+# MdlToObj : https://github.com/aiekick/MdlToObj
+)");
+        // the vertices and uvs offsets of each model are known before the writing
+        std::vector<uint32_t> vertices_offsets(vModels.size());
+        std::vector<uint32_t> uvs_offsets(vModels.size());
+        std::vector<uint32_t> normals_offsets(vModels.size());
+        uint32_t vertices_offset = 0U;
+        uint32_t uvs_offset = 0U;
+        uint32_t normals_offset = 0U;
+        for (size_t idx = 0U; idx < vModels.size(); ++idx) {
+            vertices_offsets[idx] = vertices_offset;
+            uvs_offsets[idx] = uvs_offset;
+            normals_offsets[idx] = normals_offset;
+            vertices_offset += (uint32_t)vModels[idx].getVerticesCount();
+            uvs_offset += (uint32_t)vModels[idx].getUVsCount();
+            normals_offset += (uint32_t)vModels[idx].normals.size();
+        }
+        const size_t threads_count = std::min<size_t>(m_getThreadsCount(), vModels.size());
+        if (threads_count <= 1U) {
+            for (size_t idx = 0U; idx < vModels.size(); ++idx) {
+                m_writeObjModel(vWriter, vModels[idx], vMtlFileName, vertices_offsets[idx], uvs_offsets[idx], normals_offsets[idx]);
+            }
+        } else {
+            // the models are formatted in parallel in their own buffer, by windows of models for limit the memory,
+            // then the buffers are written in order
+            std::vector<TextWriter> model_writers;
+            const size_t window_size = threads_count * 2U;
+            for (size_t idx = 0U; idx < window_size; ++idx) {
+                model_writers.emplace_back(0U);
+            }
+            for (size_t first = 0U; first < vModels.size(); first += window_size) {
+                const size_t count = std::min(window_size, vModels.size() - first);
+                m_parallelFor(count, [&](const size_t& vIdx) {
+                    auto& model_writer = model_writers[vIdx];
+                    model_writer.clear();
+                    m_writeObjModel(model_writer, vModels[first + vIdx], vMtlFileName,  //
+                                    vertices_offsets[first + vIdx], uvs_offsets[first + vIdx], normals_offsets[first + vIdx]);
+                });
+                vWriter.writeTexts(model_writers.data(), count);
+            }
+        }
+    }
+    // parse or load the source vData, then process the new models
+    bool m_openSource(const std::string& vName, const char* vData, const size_t& vSize) {
+        m_SourceFilePathName = vName;
+        m_Stats.source_bytes += vSize;
+        const auto first_model = m_Models.size();
+        const bool res = m_loadSource(vData, vSize);
+        m_Stats.draw_calls_before += m_Models.size() - first_model;
+        {
+            PhaseTimer timer(m_Stats.process_seconds);
+            m_processModels(first_model);
+        }
+        m_Stats.draw_calls_after += m_Models.size() - first_model;
+        for (size_t idx = first_model; idx < m_Models.size(); ++idx) {
+            Stats::ModelStats model;
+            model.name = m_Models[idx].name;
+            model.vertices = m_Models[idx].getVerticesCount();
+            model.faces = m_Models[idx].getFacesCount();
+            m_Stats.models.push_back(model);
+        }
+        return res;
+    }
+    // parse the source, or load it from the cache
+    bool m_loadSource(const char* vData, const size_t& vSize) {
+        if (m_CacheDirectory.empty() || !m_ComponentFilter.empty()) {  // the cache keep all the models
+            return m_parseSource(vData, vSize);
+        }
+        // the cache file is named by the hash of the source file and of the converter version
+        uint64_t hash = 0U;
+        {
+            PhaseTimer timer(m_Stats.load_seconds);
+            hash = m_getCacheKey(vData, vSize);
+        }
+        const auto cache_file = m_getCacheFilePathName(hash);
+        bool res = false;
+        {
+            PhaseTimer timer(m_Stats.parse_seconds);
+            if (m_loadCache(cache_file, hash, vSize, res)) {
+                return res;
+            }
+        }
+        const auto first_model = m_Models.size();
+        res = m_parseSource(vData, vSize);
+        PhaseTimer timer(m_Stats.write_seconds);
+        m_saveCache(cache_file, hash, vSize, first_model, res);
+        return res;
+    }
+    // the optional passes on the models from vFirstModel, once parsed or loaded from the cache
+    void m_processModels(const size_t& vFirstModel) {
+        if (m_WeldEpsilon >= 0.0 || m_VertexCacheSize || m_ComputeNormals) {
+            const size_t count = m_Models.size() - vFirstModel;
+            std::vector<PassesStats> stats(count);
+            // when the models are less than the threads, the threads left share the loops of the models
+            const size_t threads_count = std::max<size_t>(m_getThreadsCount() / std::max<size_t>(count, 1U), 1U);
+            m_parallelFor(count, [this, vFirstModel, threads_count, &stats](const size_t& vIdx) {  //
+                m_processModel(m_Models[vFirstModel + vIdx], stats[vIdx], threads_count);
+            });
+            PassesStats total;
+            for (const auto& stat : stats) {
+                total.add(stat);
+            }
+            m_logPassesStats(total);
+        }
+        if (m_MergeModels) {
+            m_mergeModels(vFirstModel);
+        }
+        if (!m_LodRatios.empty()) {
+            m_buildLods(vFirstModel);
+            if (m_ComputeNormals) {
+                std::vector<Model*> lods;
+                for (auto& level : m_Lods) {
+                    for (size_t idx = vFirstModel; idx < level.size(); ++idx) {
+                        lods.push_back(&level[idx]);
+                    }
+                }
+                m_parallelFor(lods.size(), [this, &lods](const size_t& vIdx) {  //
+                    m_computeNormals(*lods[vIdx], m_CreaseAngle, 1U);
+                });
+            }
+        }
+        if (m_Precision != Precision::Double) {
+            // the lods are made from the parsed values, so the models are compacted at last.
+            // the models compacted by m_parseMdl are skipped
+            std::vector<Model*> models;
+            for (size_t idx = vFirstModel; idx < m_Models.size(); ++idx) {
+                if (m_Models[idx].precision != m_Precision) {
+                    models.push_back(&m_Models[idx]);
+                }
+            }
+            for (auto& lods : m_Lods) {
+                for (size_t idx = vFirstModel; idx < lods.size(); ++idx) {
+                    models.push_back(&lods[idx]);
+                }
+            }
+            if (!models.empty()) {
+                std::vector<PrecisionStats> stats(models.size());
+                m_parallelFor(models.size(), [this, &models, &stats](const size_t& vIdx) {  //
+                    stats[vIdx] = m_compactModel(*models[vIdx], m_Precision);
+                });
+                m_addPrecisionStats(stats);
+            }
+        }
+    }
+    // without pass who need the parsed values, the models are compacted just after their parse, so the
+    // memory used for the parsed values is only the one of the models parsed at the same time
+    bool m_isCompactedAtParse() const {
+        return m_Precision != Precision::Double && m_CacheDirectory.empty() && m_WeldEpsilon < 0.0 && !m_VertexCacheSize && !m_ComputeNormals &&
+               !m_MergeModels && m_LodRatios.empty();
+    }
+    void m_addPrecisionStats(const std::vector<PrecisionStats>& vStats) {
+        PassesStats total;
+        for (const auto& stat : vStats) {
+            total.add(stat);
+        }
+        m_Stats.vertices_error = std::max(m_Stats.vertices_error, total.precision.vertices_error);
+        m_Stats.uvs_error = std::max(m_Stats.uvs_error, total.precision.uvs_error);
+        m_log(LogLevel::Info, "Precision : ", (m_Precision == Precision::Float ? "float" : "quantized 16 bits"), ", max error ",
+              total.precision.vertices_error, " on the positions, ", total.precision.uvs_error, " on the uvs");
+    }
+    // vData is a mdl file, or a zip file containing a mdl file
+    bool m_parseSource(const char* vData, const size_t& vSize) {
+        if (ZipArchive::isZip(vData, vSize)) {
+            const char* data = nullptr;
+            size_t size = 0U;
+            if (m_unzipMdl(vData, vSize, m_Arena.unzipped, data, size)) {
+                return m_parseMdl(data, size);
+            }
+            return false;
+        }
+        return m_parseMdl(vData, vSize);
+    }
+    // the mdl entry of the zip file vData. vOutData point in vData if the entry is stored, else in vOutBuffer
+    bool m_unzipMdl(const char* vData, const size_t& vSize, std::vector<char>& vOutBuffer, const char*& vOutData, size_t& vOutSize) {
+        ZipArchive archive;
+        if (archive.open(vData, vSize)) {
+            const auto entry = archive.findByExt(".mdl");
+            if (entry != nullptr) {
+                bool unzipped = false;
+                {
+                    PhaseTimer timer(m_Stats.load_seconds);
+                    unzipped = archive.getData(*entry, vOutBuffer, vOutData, vOutSize);
+                }
+                if (unzipped) {
+                    return true;
+                }
+                m_log(LogLevel::Error, "Fail to read ", entry->name, " from the zip file ", m_SourceFilePathName);
+            } else {
+                m_log(LogLevel::Error, "No mdl file in the zip file ", m_SourceFilePathName);
+            }
+        } else {
+            m_log(LogLevel::Error, "Fail to read the zip file ", m_SourceFilePathName);
+        }
+        return false;
+    }
+    // the buffer is parsed in two phases :
+    // - a serial scan find the PolygonMesh blocks and give them a unique name
+    // - the blocks are parsed in parallel, each in its own Model
+    bool m_parseMdl(const char* vData, const size_t& vSize) {
+        PhaseTimer timer(m_Stats.parse_seconds);
+        m_Stats.mdl_bytes += vSize;
+        if (!vSize) {
+            return false;
+        }
+        // the selected blocks are parsed, the models are in the order of the blocks
+        auto& blocks = m_Arena.blocks;
+        auto& selected = m_Arena.selected;
+        const bool save_index = m_getMeshBlocks(vData, vSize, blocks, selected);
+        const bool have_bounds = (save_index && selected.size() == blocks.size());  // the bounds are given by the parse
+        // the biggest blocks are started first, for a better balance between threads
+        auto& order = m_Arena.order;
+        order.resize(selected.size());
+        for (size_t idx = 0U; idx < order.size(); ++idx) {
+            order[idx] = idx;
+        }
+        std::sort(order.begin(), order.end(), [&blocks, &selected](const size_t& a, const size_t& b) {  // stable, without temporary buffer
+            const auto& block_a = blocks[selected[a]];
+            const auto& block_b = blocks[selected[b]];
+            const size_t size_a = block_a.end - block_a.begin;
+            const size_t size_b = block_b.end - block_b.begin;
+            return (size_a != size_b) ? (size_a > size_b) : (a < b);
+        });
+        // the models are parsed in place at the end of m_Models, the biggest released models for the biggest blocks
+        const size_t first_model = m_Models.size();
+        m_Models.resize(first_model + selected.size());
+        for (const auto& idx : order) {
+            m_Models[first_model + idx] = m_getNewModel();
+        }
+        if (m_Arena.buffers.size() < selected.size()) {
+            m_Arena.buffers.resize(selected.size());
+        }
+        const bool compact = m_isCompactedAtParse();
+        std::vector<PrecisionStats> precision_stats(compact ? selected.size() : 0U);
+        m_parallelFor(order.size(), [&](const size_t& vIdx) {
+            const auto idx = order[vIdx];
+            auto& model = m_Models[first_model + idx];
+            auto& block = blocks[selected[idx]];
+            m_parseMeshBlock(vData, block, model, m_Arena.buffers[idx]);
+            if (have_bounds) {
+                m_getBounds(model, block);
+            }
+            if (compact) {
+                precision_stats[idx] = m_compactModel(model, m_Precision);
+            }
+        });
+        if (!precision_stats.empty()) {
+            m_addPrecisionStats(precision_stats);
+        }
+        if (save_index) {
+            m_saveIndex(vData, vSize, blocks, have_bounds);
+        }
+        bool res = false;
+        if (!selected.empty()) {  // like before, the result is given by the last mesh
+            res = (m_Models.back().getVerticesCount() && !m_Models.back().indices.empty());
+        }
+        // the models of the unended blocks are removed
+        size_t models_count = first_model;
+        for (size_t idx = 0U; idx < selected.size(); ++idx) {
+            if (blocks[selected[idx]].ended) {
+                if (models_count != first_model + idx) {
+                    std::swap(m_Models[models_count], m_Models[first_model + idx]);
+                }
+                ++models_count;
+            }
+        }
+        m_releaseModels(m_Models, models_count);
+        return res;
+    }
+    // the parsed counts and the bounds of the vertices of the model, saved in the index
+    static void m_getBounds(const Model& vModel, MeshBlock& vioBlock) {
+        vioBlock.vertices_count = vModel.vertices.size();
+        vioBlock.faces_count = vModel.getFacesCount();
+        vioBlock.bounds_min = Vertex{{0.0, 0.0, 0.0}};
+        vioBlock.bounds_max = Vertex{{0.0, 0.0, 0.0}};
+        if (!vModel.vertices.empty()) {
+            vioBlock.bounds_min = vModel.vertices[0];
+            vioBlock.bounds_max = vModel.vertices[0];
+        }
+        for (const auto& vertex : vModel.vertices) {
+            for (size_t axis = 0U; axis < 3U; ++axis) {
+                vioBlock.bounds_min[axis] = std::min(vioBlock.bounds_min[axis], vertex[axis]);
+                vioBlock.bounds_max[axis] = std::max(vioBlock.bounds_max[axis], vertex[axis]);
+            }
+        }
+    }
+    // a released model if any, else a new one
+    Model m_getNewModel() {
+        if (m_Arena.models.empty()) {
+            return Model();
+        }
+        Model model = std::move(m_Arena.models.back());
+        m_Arena.models.pop_back();
+        return model;
+    }
+    // the models of vioModels from vFirstModel are cleared and kept by the arena, for the next files
+    void m_releaseModels(std::vector<Model>& vioModels, const size_t& vFirstModel) {
+        if (vFirstModel >= vioModels.size()) {
+            return;
+        }
+        for (size_t idx = vFirstModel; idx < vioModels.size(); ++idx) {
+            vioModels[idx].clear();
+            m_Arena.models.push_back(std::move(vioModels[idx]));
+        }
+        vioModels.resize(vFirstModel);
+        std::sort(m_Arena.models.begin(), m_Arena.models.end(), [](const Model& a, const Model& b) {  //
+            return m_getModelCapacity(a) < m_getModelCapacity(b);
+        });
+    }
+    // the bytes reserved by the arrays of the model
+    static size_t m_getModelCapacity(const Model& vModel) {
+        return vModel.vertices.capacity() * sizeof(Vertex) + vModel.uvs.capacity() * sizeof(UV) + vModel.indices.capacity() * sizeof(int32_t) +
+               vModel.face_sizes.capacity() * sizeof(uint32_t) + vModel.vertices_f32.capacity() * sizeof(VertexF32) +
+               vModel.uvs_f32.capacity() * sizeof(UVF32) + vModel.vertices_q16.capacity() * sizeof(VertexQ16) +
+               vModel.uvs_q16.capacity() * sizeof(UVQ16) + vModel.normals.capacity() * sizeof(Normal) +
+               vModel.normal_indices.capacity() * sizeof(uint32_t);
+    }
+    // the file name of the texture used by the model
+    static void m_addTexture(const Model& vModel, std::set<std::string>& vioTextures) {
+        // the texture value can end with spaces
+        const auto end = vModel.mat.ka_texture.find_last_not_of(' ');
+        if (end != std::string::npos) {
+            vioTextures.emplace(m_getFileName(vModel.mat.ka_texture.substr(0U, end + 1U)));
+        }
+    }
+    std::set<std::string> m_getTextures() const {
+        std::set<std::string> textures;
+        for (const auto& model : m_Models) {
+            m_addTexture(model, textures);
+        }
+        return textures;
+    }
+    // extract the textures vTextures from the source zip file, in vDir
+    void m_extractTextures(const std::string& vDir, const std::set<std::string>& vTextures) {
+        InputFile source;
+        ZipArchive archive;
+        if (source.open(m_SourceFilePathName, m_UseMemoryMapping) && ZipArchive::isZip(source.data(), source.size()) &&
+            archive.open(source.data(), source.size())) {
+            for (const auto& texture : vTextures) {
+                const auto entry = archive.findByFileName(texture);
+                std::vector<char> buffer;
+                const char* data = nullptr;
+                size_t size = 0U;
+                if (entry != nullptr && archive.getData(*entry, buffer, data, size)) {
+                    TextWriter writer(0U);
+                    if (writer.open(vDir + texture, true)) {
+                        writer.write(data, size);
+                        const bool closed = writer.close();
+                        m_Stats.written_bytes += writer.getWrittenSize();
+                        if (closed) {
+                            m_log(LogLevel::Info, "Texture extracted : ", vDir + texture);
+                            continue;
+                        }
+                    }
+                }
+                m_log(LogLevel::Error, "Fail to extract the texture ", texture);
+            }
+        }
+    }
+    // xxHash64, fast enough to hash the source file at each open
+    static uint64_t m_hash64(const char* vData, const size_t& vSize, const uint64_t& vSeed) {
+        static const uint64_t p1 = 11400714785074694791ULL;
+        static const uint64_t p2 = 14029467366897019727ULL;
+        static const uint64_t p3 = 1609587929392839161ULL;
+        static const uint64_t p4 = 9650029242287828579ULL;
+        static const uint64_t p5 = 2870177450012600261ULL;
+        auto rotl = [](const uint64_t& vX, const int& vR) { return (vX << vR) | (vX >> (64 - vR)); };
+        auto round = [&rotl](const uint64_t& vAcc, const uint64_t& vInput) { return rotl(vAcc + vInput * p2, 31) * p1; };
+        auto read64 = [](const char* vPtr) {
+            uint64_t v;
+            memcpy(&v, vPtr, sizeof(v));
+            return v;
+        };
+        const char* ptr = vData;
+        const char* end = vData + vSize;
+        uint64_t h = 0U;
+        if (vSize >= 32U) {
+            uint64_t v[4] = {vSeed + p1 + p2, vSeed + p2, vSeed, vSeed - p1};
+            for (; ptr + 32U <= end; ptr += 32U) {
+                for (size_t i = 0U; i < 4U; ++i) {
+                    v[i] = round(v[i], read64(ptr + i * 8U));
+                }
+            }
+            h = rotl(v[0], 1) + rotl(v[1], 7) + rotl(v[2], 12) + rotl(v[3], 18);
+            for (size_t i = 0U; i < 4U; ++i) {
+                h = (h ^ round(0U, v[i])) * p1 + p4;
+            }
+        } else {
+            h = vSeed + p5;
+        }
+        h += vSize;
+        for (; ptr + 8U <= end; ptr += 8U) {
+            h = rotl(h ^ round(0U, read64(ptr)), 27) * p1 + p4;
+        }
+        if (ptr + 4U <= end) {
+            uint32_t v;
+            memcpy(&v, ptr, sizeof(v));
+            h = rotl(h ^ (v * p1), 23) * p2 + p3;
+            ptr += 4U;
+        }
+        for (; ptr < end; ++ptr) {
+            h = rotl(h ^ ((uint8_t)*ptr * p5), 11) * p1;
+        }
+        h ^= h >> 33U;
+        h *= p2;
+        h ^= h >> 29U;
+        h *= p3;
+        h ^= h >> 32U;
+        return h;
+    }
+    // a new converter version or cache format give a new key, so the old cache files are never loaded
+    static uint64_t m_getCacheKey(const char* vData, const size_t& vSize) {
+        const std::string version = MDL_TO_OBJ_VERSION "/" + std::to_string(s_CacheFormatVersion);
+        return m_hash64(vData, vSize, m_hash64(version.data(), version.size(), 0U));
+    }
+    std::string m_getCacheFilePathName(const uint64_t& vKey) const {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.mdlcache", (unsigned long long)vKey);
+        const char last = m_CacheDirectory.back();
+        return m_CacheDirectory + ((last == '/' || last == '\\') ? "" : "/") + name;
+    }
+    static CacheHeader m_getCacheHeader(const uint64_t& vKey, const size_t& vSourceSize) {
+        CacheHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, "MDLCACHE", sizeof(header.magic));
+        header.endian_tag = 0x01020304U;
+        header.format_version = s_CacheFormatVersion;
+        strncpy(header.converter_version, MDL_TO_OBJ_VERSION, sizeof(header.converter_version) - 1U);
+        header.key = vKey;
+        header.source_size = vSourceSize;
+        return header;
+    }
+    // return false when the cache file is missing, outdated or corrupted, vOutResult is then not set
+    bool m_loadCache(const std::string& vCacheFile, const uint64_t& vKey, const size_t& vSourceSize, bool& vOutResult) {
+        InputFile cache;
+        if (!cache.open(vCacheFile, true)) {
+            return false;  // not in the cache
+        }
+        CacheHeader header;
+        const auto expected = m_getCacheHeader(vKey, vSourceSize);
+        if (cache.size() < sizeof(header)) {
+            m_log(LogLevel::Error, "The cache file ", vCacheFile, " is corrupted");
+            return false;
+        }
+        memcpy(&header, cache.data(), sizeof(header));
+        if (memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 || header.endian_tag != expected.endian_tag ||
+            header.format_version != expected.format_version ||
+            memcmp(header.converter_version, expected.converter_version, sizeof(header.converter_version)) != 0 ||
+            header.key != expected.key || header.source_size != expected.source_size) {
+            m_log(LogLevel::Info, "The cache file ", vCacheFile, " is outdated");
+            return false;
+        }
+        CacheReader reader(cache.data() + sizeof(header), cache.size() - sizeof(header));
+        std::vector<Model> models;
+        std::vector<std::pair<std::string, std::string>> components;  // component and surface of each model
+        while (models.size() < header.models_count && !reader.isFailed()) {
+            models.push_back(m_getNewModel());
+            components.emplace_back();
+            auto& model = models.back();
+            auto& mat = model.mat;
+            uint8_t smooth_shading = 0U;
+            reader.read(components.back().first);
+            reader.read(components.back().second);
+            reader.read(smooth_shading);
+            reader.read(mat.Ns);
+            reader.read(mat.Ka);
+            reader.read(mat.Ks);
+            reader.read(mat.Kd);
+            reader.read(mat.Ke);
+            reader.read(mat.Ni);
+            reader.read(mat.d);
+            reader.read(mat.illum);
+            reader.read(mat.ka_texture);
+            reader.read(model.vertices);
+            reader.read(model.uvs);
+            reader.read(model.indices);
+            reader.read(model.face_sizes);
+            model.smooth_shading = (smooth_shading != 0U);
+        }
+        if (!reader.isEnded() || models.size() != header.models_count) {
+            m_log(LogLevel::Error, "The cache file ", vCacheFile, " is corrupted");
+            m_releaseModels(models, 0U);
+            return false;
+        }
+        m_Models.reserve(m_Models.size() + models.size());
+        for (size_t idx = 0U; idx < models.size(); ++idx) {
+            auto& model = models[idx];
+            model.name = m_getUniqueName(components[idx].first, components[idx].second);
+            model.mat.name = model.name;
+            m_Models.push_back(std::move(model));
+        }
+        m_log(LogLevel::Info, "Models loaded from the cache file ", vCacheFile);
+        vOutResult = (header.parse_result != 0U);
+        return true;
+    }
+    // the models from vFirstModel are saved. the file is written under a temporary name, then renamed,
+    // so a cache file is always complete even if two conversions of the same file are running
+    void m_saveCache(const std::string& vCacheFile, const uint64_t& vKey, const size_t& vSourceSize, const size_t& vFirstModel,
+                     const bool& vResult) {
+        const auto tmp_file = m_getTempFilePathName(vCacheFile);
+        TextWriter writer;
+        if (!writer.open(tmp_file, true)) {
+            m_log(LogLevel::Error, "Fail to save the cache file ", vCacheFile);
+            return;
+        }
+        auto header = m_getCacheHeader(vKey, vSourceSize);
+        header.models_count = m_Models.size() - vFirstModel;
+        header.parse_result = vResult ? 1U : 0U;
+        m_writeCache(writer, header);
+        // the models are those of the ended blocks of the parsed file, in the order of the blocks
+        size_t block_idx = 0U;
+        for (size_t idx = vFirstModel; idx < m_Models.size(); ++idx) {
+            while (!m_Arena.blocks[block_idx].ended) {
+                ++block_idx;
+            }
+            const auto& block = m_Arena.blocks[block_idx++];
+            const auto& model = m_Models[idx];
+            const auto& mat = model.mat;
+            m_writeCache(writer, block.component);
+            m_writeCache(writer, block.surface);
+            m_writeCache(writer, (uint8_t)(model.smooth_shading ? 1U : 0U));
+            m_writeCache(writer, mat.Ns);
+            m_writeCache(writer, mat.Ka);
+            m_writeCache(writer, mat.Ks);
+            m_writeCache(writer, mat.Kd);
+            m_writeCache(writer, mat.Ke);
+            m_writeCache(writer, mat.Ni);
+            m_writeCache(writer, mat.d);
+            m_writeCache(writer, mat.illum);
+            m_writeCache(writer, mat.ka_texture);
+            m_writeCache(writer, model.vertices);
+            m_writeCache(writer, model.uvs);
+            m_writeCache(writer, model.indices);
+            m_writeCache(writer, model.face_sizes);
+        }
+        bool res = writer.close();
+        m_Stats.written_bytes += writer.getWrittenSize();
+        if (res) {
+            std::remove(vCacheFile.c_str());  // needed by rename on windows
+            res = (std::rename(tmp_file.c_str(), vCacheFile.c_str()) == 0);
+        }
+        if (!res) {
+            std::remove(tmp_file.c_str());
+            m_log(LogLevel::Error, "Fail to save the cache file ", vCacheFile);
+        }
+    }
+    static IndexHeader m_getIndexHeader(const size_t& vMdlSize) {
+        IndexHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, "MDLINDEX", sizeof(header.magic));
+        header.endian_tag = 0x01020304U;
+        header.format_version = s_IndexFormatVersion;
+        header.mdl_size = vMdlSize;
+        return header;
+    }
+    // return false when the index file is missing, corrupted or made for another mdl text.
+    // the hashes of the blocks are checked by m_getMeshBlocks, only for the blocks parsed
+    bool m_loadIndex(const size_t& vMdlSize, std::vector<MeshBlock>& vioBlocks, bool& vOutHaveBounds) {
+        InputFile index;
+        if (!index.open(m_IndexFilePathName, true)) {
+            return false;  // not indexed
+        }
+        IndexHeader header;
+        const auto expected = m_getIndexHeader(vMdlSize);
+        if (index.size() < sizeof(header)) {
+            m_log(LogLevel::Error, "The index file ", m_IndexFilePathName, " is corrupted");
+            return false;
+        }
+        memcpy(&header, index.data(), sizeof(header));
+        if (memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 || header.endian_tag != expected.endian_tag ||
+            header.format_version != expected.format_version || header.mdl_size != expected.mdl_size) {
+            m_log(LogLevel::Info, "The index file ", m_IndexFilePathName, " is outdated");
+            return false;
+        }
+        CacheReader reader(index.data() + sizeof(header), index.size() - sizeof(header));
+        bool res = (header.blocks_count <= index.size() / 16U);  // the two string sizes at least by block
+        if (res) {
+            vioBlocks.resize((size_t)header.blocks_count);
+            for (auto& block : vioBlocks) {
+                uint64_t begin = 0U;
+                uint64_t end = 0U;
+                uint8_t ended = 0U;
+                reader.read(block.component);
+                reader.read(block.surface);
+                reader.read(begin);
+                reader.read(end);
+                reader.read(ended);
+                reader.read(block.vertices_count);
+                reader.read(block.faces_count);
+                reader.read(block.bounds_min);
+                reader.read(block.bounds_max);
+                reader.read(block.hash);
+                block.begin = (size_t)begin;
+                block.end = (size_t)end;
+                block.ended = (ended != 0U);
+                res &= (begin <= end && end <= vMdlSize);
+            }
+            res &= reader.isEnded();
+        }
+        if (!res) {
+            m_log(LogLevel::Error, "The index file ", m_IndexFilePathName, " is corrupted");
+            return false;
+        }
+        vOutHaveBounds = (header.have_bounds != 0U);
+        m_log(LogLevel::Info, "Meshes found in the index file ", m_IndexFilePathName);
+        return true;
+    }
+    // written under a temporary name then renamed, like the cache files
+    void m_saveIndex(const char* vData, const size_t& vSize, const std::vector<MeshBlock>& vBlocks, const bool& vHaveBounds) {
+        const auto tmp_file = m_getTempFilePathName(m_IndexFilePathName);
+        TextWriter writer;
+        if (!writer.open(tmp_file, true)) {
+            m_log(LogLevel::Error, "Fail to save the index file ", m_IndexFilePathName);
+            return;
+        }
+        auto header = m_getIndexHeader(vSize);
+        header.blocks_count = vBlocks.size();
+        header.have_bounds = vHaveBounds ? 1U : 0U;
+        m_writeCache(writer, header);
+        for (const auto& block : vBlocks) {
+            m_writeCache(writer, block.component);
+            m_writeCache(writer, block.surface);
+            m_writeCache(writer, (uint64_t)block.begin);
+            m_writeCache(writer, (uint64_t)block.end);
+            m_writeCache(writer, (uint8_t)(block.ended ? 1U : 0U));
+            m_writeCache(writer, block.vertices_count);
+            m_writeCache(writer, block.faces_count);
+            m_writeCache(writer, block.bounds_min);
+            m_writeCache(writer, block.bounds_max);
+            m_writeCache(writer, m_hash64(vData + block.begin, block.end - block.begin, 0U));
+        }
+        bool res = writer.close();
+        m_Stats.written_bytes += writer.getWrittenSize();
+        if (res) {
+            std::remove(m_IndexFilePathName.c_str());  // needed by rename on windows
+            res = (std::rename(tmp_file.c_str(), m_IndexFilePathName.c_str()) == 0);
+        }
+        if (res) {
+            m_log(LogLevel::Info, "Index saved in ", m_IndexFilePathName);
+        } else {
+            std::remove(tmp_file.c_str());
+            m_log(LogLevel::Error, "Fail to save the index file ", m_IndexFilePathName);
+        }
+    }
+    template <typename T>
+    static void m_writeCache(TextWriter& vWriter, const T& vValue) {
+        vWriter.write(reinterpret_cast<const char*>(&vValue), sizeof(T));
+    }
+    static void m_writeCache(TextWriter& vWriter, const std::string& vStr) {
+        m_writeCache(vWriter, (uint64_t)vStr.size());
+        vWriter.write(vStr);
+    }
+    template <typename T>
+    static void m_writeCache(TextWriter& vWriter, const std::vector<T>& vItems) {
+        m_writeCache(vWriter, (uint64_t)vItems.size());
+        vWriter.write(reinterpret_cast<const char*>(vItems.data()), vItems.size() * sizeof(T));
+    }
+    // weld, vertex cache and normals passes on one model.
+    // the loops of the normals pass are shared between vThreadsCount threads
+    void m_processModel(Model& vioModel, PassesStats& vioStats, const size_t& vThreadsCount) const {
+        if (m_WeldEpsilon >= 0.0) {
+            vioStats.add(m_weldModel(vioModel, m_WeldEpsilon));
+        }
+        if (m_VertexCacheSize) {
+            vioStats.add(m_optimizeModel(vioModel, m_VertexCacheSize, m_OptimizeOverdraw));
+        }
+        if (m_ComputeNormals) {
+            vioStats.add(m_computeNormals(vioModel, m_CreaseAngle, vThreadsCount));
+        }
+    }
+    void m_logPassesStats(const PassesStats& vStats) const {
+        if (m_WeldEpsilon >= 0.0) {
+            m_log(LogLevel::Info, "Welding : ", vStats.weld.vertices_removed, " vertices and ", vStats.weld.faces_removed, " degenerated faces removed");
+        }
+        const auto& cache = vStats.vertex_cache;
+        if (m_VertexCacheSize && cache.triangles_count) {
+            const auto triangles_count = (double)cache.triangles_count;
+            const auto vertices_count = (double)std::max<size_t>(cache.vertices_count, 1U);
+            m_log(LogLevel::Info, "Vertex cache : ACMR ", cache.misses_before / triangles_count, " -> ", cache.misses_after / triangles_count,  //
+                  ", ATVR ", cache.misses_before / vertices_count, " -> ", cache.misses_after / vertices_count);
+        }
+        if (m_ComputeNormals) {
+            m_log(LogLevel::Info, "Normals : ", vStats.normals.normals_count, " normals, ", vStats.normals.smooth_models, " smooth shaded models, ",
+                  vStats.normals.flat_models, " flat shaded models");
+        }
+    }
+    // store the vertices and uvs of the model in vPrecision, the parsed values are released
+    static PrecisionStats m_compactModel(Model& vioModel, const Precision& vPrecision) {
+        PrecisionStats stats;
+        if (vioModel.precision != Precision::Double || vPrecision == Precision::Double) {
+            return stats;
+        }
+        auto& model = vioModel;
+        if (vPrecision == Precision::Float) {
+            model.vertices_f32.resize(model.vertices.size());
+            for (size_t idx = 0U; idx < model.vertices.size(); ++idx) {
+                for (size_t c = 0U; c < 3U; ++c) {
+                    model.vertices_f32[idx][c] = (float)model.vertices[idx][c];
+                }
+            }
+            model.uvs_f32.resize(model.uvs.size());
+            for (size_t idx = 0U; idx < model.uvs.size(); ++idx) {
+                for (size_t c = 0U; c < 2U; ++c) {
+                    model.uvs_f32[idx][c] = (float)model.uvs[idx][c];
+                }
+            }
+        } else {
+            m_quantize(model.vertices, model.vertices_min, model.vertices_step, model.vertices_q16);
+            m_quantize(model.uvs, model.uvs_min, model.uvs_step, model.uvs_q16);
+        }
+        model.precision = vPrecision;
+        for (size_t idx = 0U; idx < model.vertices.size(); ++idx) {
+            const auto vertex = model.getVertex(idx);
+            for (size_t c = 0U; c < 3U; ++c) {
+                stats.vertices_error = std::max(stats.vertices_error, std::fabs(vertex[c] - model.vertices[idx][c]));
+            }
+        }
+        for (size_t idx = 0U; idx < model.uvs.size(); ++idx) {
+            const auto uv = model.getUV(idx);
+            for (size_t c = 0U; c < 2U; ++c) {
+                stats.uvs_error = std::max(stats.uvs_error, std::fabs(uv[c] - model.uvs[idx][c]));
+            }
+        }
+        std::vector<Vertex>().swap(model.vertices);
+        std::vector<UV>().swap(model.uvs);
+        return stats;
+    }
+    // 16 bits values relative to the bounds of vValues, the error is at most the half of vOutStep
+    template <size_t N>
+    static void m_quantize(const std::vector<std::array<double, N>>& vValues, std::array<double, N>& vOutMin, std::array<double, N>& vOutStep,
+                           std::vector<std::array<uint16_t, N>>& vOutQuantized) {
+        for (size_t c = 0U; c < N; ++c) {
+            double min = vValues.empty() ? 0.0 : vValues[0][c];
+            double max = min;
+            for (const auto& value : vValues) {
+                min = std::min(min, value[c]);
+                max = std::max(max, value[c]);
+            }
+            vOutMin[c] = min;
+            vOutStep[c] = (max - min) / 65535.0;
+            if (!(vOutStep[c] > 0.0)) {
+                vOutStep[c] = 1.0;  // flat axis, all the values are min
+            }
+        }
+        vOutQuantized.resize(vValues.size());
+        for (size_t idx = 0U; idx < vValues.size(); ++idx) {
+            for (size_t c = 0U; c < N; ++c) {
+                const double q = std::floor((vValues[idx][c] - vOutMin[c]) / vOutStep[c] + 0.5);
+                vOutQuantized[idx][c] = (uint16_t)std::min(std::max(q, 0.0), 65535.0);
+            }
+        }
+    }
+    // normals of the model from the parsed positions, see setComputeNormals.
+    // a flat shaded model have the normal of each face. on a smooth shaded model, the normal of an item of a face is the mean
+    // of the normals of the faces around its position, weighted by the angles of the faces at this position. the vertices at
+    // the same position (like on the uv seams) are smoothed together, and the faces who form an angle bigger than vCreaseAngle
+    // with the face of the item are not in the mean. the same normals of a position are stored once.
+    // the faces and the positions are in structure of arrays, and their loops are shared between vThreadsCount threads
+    static NormalsStats m_computeNormals(Model& vioModel, const double& vCreaseAngle, const size_t& vThreadsCount) {
+        NormalsStats stats;
+        auto& model = vioModel;
+        const size_t vertices_count = model.vertices.size();
+        const size_t items_count = model.indices.size();
+        const size_t faces_count = model.getFacesCount();
+        static const uint32_t no_id = 0xFFFFFFFFU;
+
+        // the begin of each face in the indices, then the face and the vertex of each item (no_id if out of range)
+        std::vector<uint32_t> face_begins(faces_count + 1U, 0U);
+        for (size_t face = 0U; face < faces_count; ++face) {
+            face_begins[face + 1U] = face_begins[face] + (model.face_sizes.empty() ? 3U : model.face_sizes[face]);
+        }
+        std::vector<uint32_t> item_faces(items_count);
+        std::vector<uint32_t> item_vertices(items_count);
+        for (size_t face = 0U; face < faces_count; ++face) {
+            for (uint32_t item = face_begins[face]; item < face_begins[face + 1U]; ++item) {
+                const int64_t idx = model.indices[item];
+                const int64_t id = (idx < 0) ? idx + (int64_t)vertices_count : idx;
+                item_faces[item] = (uint32_t)face;
+                item_vertices[item] = (id >= 0 && id < (int64_t)vertices_count) ? (uint32_t)id : no_id;
+            }
+        }
+        std::vector<double> px(vertices_count);
+        std::vector<double> py(vertices_count);
+        std::vector<double> pz(vertices_count);
+        for (size_t idx = 0U; idx < vertices_count; ++idx) {
+            px[idx] = model.vertices[idx][0];
+            py[idx] = model.vertices[idx][1];
+            pz[idx] = model.vertices[idx][2];
+        }
+
+        // unit normals of the faces, from the sum of the triangles of their fan. 0 for the degenerated faces
+        std::vector<double> fx(faces_count);
+        std::vector<double> fy(faces_count);
+        std::vector<double> fz(faces_count);
+        m_parallelRanges(faces_count, vThreadsCount, [&](const size_t& vBegin, const size_t& vEnd) {
+            for (size_t face = vBegin; face < vEnd; ++face) {
+                double nx = 0.0, ny = 0.0, nz = 0.0;
+                const uint32_t i0 = item_vertices[face_begins[face]];
+                for (uint32_t item = face_begins[face] + 2U; item < face_begins[face + 1U]; ++item) {
+                    const uint32_t i1 = item_vertices[item - 1U];
+                    const uint32_t i2 = item_vertices[item];
+                    if (i0 != no_id && i1 != no_id && i2 != no_id) {
+                        const double e1x = px[i1] - px[i0], e1y = py[i1] - py[i0], e1z = pz[i1] - pz[i0];
+                        const double e2x = px[i2] - px[i0], e2y = py[i2] - py[i0], e2z = pz[i2] - pz[i0];
+                        nx += e1y * e2z - e1z * e2y;
+                        ny += e1z * e2x - e1x * e2z;
+                        nz += e1x * e2y - e1y * e2x;
+                    }
+                }
+                fx[face] = nx;
+                fy[face] = ny;
+                fz[face] = nz;
+            }
+            for (size_t face = vBegin; face < vEnd; ++face) {
+                const double len = std::sqrt(fx[face] * fx[face] + fy[face] * fy[face] + fz[face] * fz[face]);
+                const double inv = (len > 0.0) ? 1.0 / len : 0.0;
+                fx[face] *= inv;
+                fy[face] *= inv;
+                fz[face] *= inv;
+            }
+        });
+
+        model.normals.clear();
+        model.normal_indices.assign(items_count, 0U);
+        if (!model.smooth_shading) {
+            model.normals.resize(faces_count);
+            m_parallelRanges(faces_count, vThreadsCount, [&](const size_t& vBegin, const size_t& vEnd) {
+                for (size_t face = vBegin; face < vEnd; ++face) {
+                    model.normals[face] = m_getNormal(fx[face], fy[face], fz[face]);
+                    for (uint32_t item = face_begins[face]; item < face_begins[face + 1U]; ++item) {
+                        model.normal_indices[item] = (uint32_t)face;
+                    }
+                }
+            });
+            stats.flat_models = 1U;
+            stats.normals_count = model.normals.size();
+            return stats;
+        }
+
+        // angle of each item in its face, between the edges to the previous and to the next items
+        std::vector<double> weights(items_count, 0.0);
+        m_parallelRanges(faces_count, vThreadsCount, [&](const size_t& vBegin, const size_t& vEnd) {
+            for (size_t face = vBegin; face < vEnd; ++face) {
+                const uint32_t begin = face_begins[face];
+                const uint32_t size = face_begins[face + 1U] - begin;
+                for (uint32_t k = 0U; k < size; ++k) {
+                    const uint32_t cur = item_vertices[begin + k];
+                    const uint32_t prev = item_vertices[begin + (k + size - 1U) % size];
+                    const uint32_t next = item_vertices[begin + (k + 1U) % size];
+                    if (cur != no_id && prev != no_id && next != no_id) {
+                        const double ax = px[prev] - px[cur], ay = py[prev] - py[cur], az = pz[prev] - pz[cur];
+                        const double bx = px[next] - px[cur], by = py[next] - py[cur], bz = pz[next] - pz[cur];
+                        const double cx = ay * bz - az * by, cy = az * bx - ax * bz, cz = ax * by - ay * bx;
+                        weights[begin + k] = std::atan2(std::sqrt(cx * cx + cy * cy + cz * cz), ax * bx + ay * by + az * bz);
+                    }
+                }
+            }
+        });
+
+        // the items of each position
+        std::vector<uint32_t> by_position(vertices_count);
+        for (size_t idx = 0U; idx < vertices_count; ++idx) {
+            by_position[idx] = (uint32_t)idx;
+        }
+        std::sort(by_position.begin(), by_position.end(), [&model](const uint32_t& a, const uint32_t& b) {  //
+            return model.vertices[a] < model.vertices[b];
+        });
+        std::vector<uint32_t> position_ids(vertices_count);
+        size_t positions_count = 0U;
+        for (size_t idx = 0U; idx < vertices_count; ++idx) {
+            if (idx && model.vertices[by_position[idx]] != model.vertices[by_position[idx - 1U]]) {
+                ++positions_count;
+            }
+            position_ids[by_position[idx]] = (uint32_t)positions_count;
+        }
+        positions_count += vertices_count ? 1U : 0U;
+        std::vector<uint32_t> position_begins(positions_count + 1U, 0U);
+        bool have_bad_items = false;
+        for (size_t item = 0U; item < items_count; ++item) {
+            if (item_vertices[item] != no_id) {
+                ++position_begins[position_ids[item_vertices[item]] + 1U];
+            } else {
+                have_bad_items = true;
+            }
+        }
+        for (size_t position = 0U; position < positions_count; ++position) {
+            position_begins[position + 1U] += position_begins[position];
+        }
+        std::vector<uint32_t> position_items(position_begins.back());
+        {
+            std::vector<uint32_t> cursors(position_begins.begin(), position_begins.end() - 1);
+            for (size_t item = 0U; item < items_count; ++item) {
+                if (item_vertices[item] != no_id) {
+                    position_items[cursors[position_ids[item_vertices[item]]]++] = (uint32_t)item;
+                }
+            }
+        }
+
+        // normal of each item, and its id in the normals of its position
+        const double crease_cos = std::cos(std::min(std::max(vCreaseAngle, 0.0), 180.0) * 3.14159265358979323846 / 180.0);
+        const bool creased = (vCreaseAngle < 180.0);
+        std::vector<Normal> item_normals(items_count);
+        std::vector<uint32_t> position_normals(positions_count + 1U, 0U);
+        m_parallelRanges(positions_count, vThreadsCount, [&](const size_t& vBegin, const size_t& vEnd) {
+            for (size_t position = vBegin; position < vEnd; ++position) {
+                const uint32_t begin = position_begins[position];
+                const uint32_t end = position_begins[position + 1U];
+                uint32_t count = 0U;
+                for (uint32_t idx = begin; idx < end; ++idx) {
+                    const uint32_t item = position_items[idx];
+                    const uint32_t face = item_faces[item];
+                    if (!creased && idx > begin) {  // all the items of the position have the normal of the first one
+                        item_normals[item] = item_normals[position_items[begin]];
+                        continue;
+                    }
+                    double nx = 0.0, ny = 0.0, nz = 0.0;
+                    for (uint32_t other = begin; other < end; ++other) {
+                        const uint32_t other_item = position_items[other];
+                        const uint32_t other_face = item_faces[other_item];
+                        const double dot = fx[face] * fx[other_face] + fy[face] * fy[other_face] + fz[face] * fz[other_face];
+                        const double weight = (!creased || dot >= crease_cos) ? weights[other_item] : 0.0;
+                        nx += fx[other_face] * weight;
+                        ny += fy[other_face] * weight;
+                        nz += fz[other_face] * weight;
+                    }
+                    const double len = std::sqrt(nx * nx + ny * ny + nz * nz);
+                    item_normals[item] = (len > 0.0) ? m_getNormal(nx / len, ny / len, nz / len) : m_getNormal(fx[face], fy[face], fz[face]);
+                }
+                for (uint32_t idx = begin; idx < end; ++idx) {
+                    const uint32_t item = position_items[idx];
+                    uint32_t id = count;
+                    for (uint32_t prev = begin; prev < idx; ++prev) {
+                        if (item_normals[position_items[prev]] == item_normals[item]) {
+                            id = model.normal_indices[position_items[prev]];
+                            break;
+                        }
+                    }
+                    model.normal_indices[item] = id;
+                    count += (id == count) ? 1U : 0U;
+                }
+                position_normals[position + 1U] = count;
+            }
+        });
+
+        // the normals of the positions one after the other, then the normal of the items out of range
+        for (size_t position = 0U; position < positions_count; ++position) {
+            position_normals[position + 1U] += position_normals[position];
+        }
+        model.normals.resize(position_normals.back() + (have_bad_items ? 1U : 0U));
+        m_parallelRanges(positions_count, vThreadsCount, [&](const size_t& vBegin, const size_t& vEnd) {
+            for (size_t position = vBegin; position < vEnd; ++position) {
+                for (uint32_t idx = position_begins[position]; idx < position_begins[position + 1U]; ++idx) {
+                    const uint32_t item = position_items[idx];
+                    model.normal_indices[item] += position_normals[position];
+                    model.normals[model.normal_indices[item]] = item_normals[item];
+                }
+            }
+        });
+        if (have_bad_items) {
+            model.normals.back() = m_getNormal(0.0, 0.0, 0.0);
+            for (size_t item = 0U; item < items_count; ++item) {
+                if (item_vertices[item] == no_id) {
+                    model.normal_indices[item] = (uint32_t)model.normals.size() - 1U;
+                }
+            }
+        }
+        stats.smooth_models = 1U;
+        stats.normals_count = model.normals.size();
+        return stats;
+    }
+    // the unit vector vX, vY, vZ in float. the null vector give the z axis
+    static Normal m_getNormal(const double& vX, const double& vY, const double& vZ) {
+        if (vX == 0.0 && vY == 0.0 && vZ == 0.0) {
+            return Normal{{0.0f, 0.0f, 1.0f}};
+        }
+        return Normal{{(float)vX, (float)vY, (float)vZ}};
+    }
+    // the vertices are put in a grid of vEpsilon cells. a vertex is merged with the first kept vertex
+    // of its cell or of the 26 neighbour cells, closer than vEpsilon on each position and uv coordinate.
+    // the models with an uv count different of the vertex count, or with bad indices, are not welded
+    static WeldStats m_weldModel(Model& vioModel, const double& vEpsilon) {
+        WeldStats stats;
+        const size_t vertices_count = vioModel.vertices.size();
+        const bool have_uvs = !vioModel.uvs.empty();
+        if (vertices_count == 0U || (have_uvs && vioModel.uvs.size() != vertices_count)) {
+            return stats;
+        }
+        const auto cell_size = (vEpsilon > 0.0) ? vEpsilon : 1.0;
+        auto get_cell = [&vEpsilon, &cell_size](const double& vValue) {
+            // + 0.0 for have the same cell for -0.0 and 0.0
+            return ((vEpsilon > 0.0) ? std::floor(vValue / cell_size) : vValue) + 0.0;
+        };
+        auto get_cell_key = [](const double& vX, const double& vY, const double& vZ) {
+            uint64_t bits[3];
+            memcpy(&bits[0], &vX, sizeof(double));
+            memcpy(&bits[1], &vY, sizeof(double));
+            memcpy(&bits[2], &vZ, sizeof(double));
+            return ((bits[0] * 73856093ULL) ^ (bits[1] * 19349663ULL) ^ (bits[2] * 83492791ULL)) + (bits[0] >> 32U);
+        };
+        auto is_near = [&vioModel, &vEpsilon, &have_uvs](const size_t& vA, const size_t& vB) {
+            for (size_t c = 0U; c < 3U; ++c) {
+                if (std::fabs(vioModel.vertices[vA][c] - vioModel.vertices[vB][c]) > vEpsilon) {
+                    return false;
+                }
+            }
+            return !have_uvs || (std::fabs(vioModel.uvs[vA][0] - vioModel.uvs[vB][0]) <= vEpsilon &&
+                                 std::fabs(vioModel.uvs[vA][1] - vioModel.uvs[vB][1]) <= vEpsilon);
+        };
+
+        // the kept vertices of a cell are chained by next_in_cell, from the head of the cell
+        static const uint32_t no_vertex = 0xFFFFFFFFU;
+        std::unordered_map<uint64_t, uint32_t> cells_heads;
+        cells_heads.reserve(vertices_count);
+        std::vector<uint32_t> next_in_cell(vertices_count, no_vertex);
+        std::vector<uint32_t> remap(vertices_count);
+        std::vector<uint32_t> kept;
+        kept.reserve(vertices_count);
+        const int range = (vEpsilon > 0.0) ? 1 : 0;
+        for (size_t idx = 0U; idx < vertices_count; ++idx) {
+            const auto& vertex = vioModel.vertices[idx];
+            const double cell[3] = {get_cell(vertex[0]), get_cell(vertex[1]), get_cell(vertex[2])};
+            uint32_t found = no_vertex;
+            for (int x = -range; x <= range && found == no_vertex; ++x) {
+                for (int y = -range; y <= range && found == no_vertex; ++y) {
+                    for (int z = -range; z <= range && found == no_vertex; ++z) {
+                        const auto it = cells_heads.find(get_cell_key(cell[0] + x, cell[1] + y, cell[2] + z));
+                        for (auto other = (it != cells_heads.end()) ? it->second : no_vertex; other != no_vertex; other = next_in_cell[other]) {
+                            if (is_near(other, idx)) {
+                                found = other;
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+            if (found != no_vertex) {
+                remap[idx] = remap[found];
+            } else {
+                remap[idx] = (uint32_t)kept.size();
+                kept.push_back((uint32_t)idx);
+                auto& head = cells_heads.emplace(get_cell_key(cell[0], cell[1], cell[2]), no_vertex).first->second;
+                next_in_cell[idx] = head;
+                head = (uint32_t)idx;
+            }
+        }
+
+        // the indices are remapped, and the consecutive same indices removed
+        std::vector<int32_t> face;
+        Model welded;
+        welded.indices.reserve(vioModel.indices.size());
+        const auto* indices = vioModel.indices.data();
+        const auto faces_count = vioModel.getFacesCount();
+        for (size_t face_id = 0U; face_id < faces_count; ++face_id) {
+            const size_t face_size = vioModel.face_sizes.empty() ? 3U : vioModel.face_sizes[face_id];
+            face.clear();
+            for (size_t i = 0U; i < face_size; ++i) {
+                const int64_t id = (indices[i] < 0) ? (int64_t)indices[i] + (int64_t)vertices_count : indices[i];
+                if (id < 0 || id >= (int64_t)vertices_count) {
+                    return WeldStats();  // bad index, the model is not changed
+                }
+                const auto new_id = (int32_t)remap[(size_t)id];
+                if (face.empty() || face.back() != new_id) {
+                    face.push_back(new_id);
+                }
+            }
+            while (face.size() > 1U && face.back() == face.front()) {
+                face.pop_back();
+            }
+            if (face.size() >= 3U && (face.size() > 3U || face[0] != face[2])) {
+                welded.addFace(face.data(), face.size());
+            } else {
+                ++stats.faces_removed;
+            }
+            indices += face_size;
+        }
+        welded.vertices.reserve(kept.size());
+        for (const auto& idx : kept) {
+            welded.vertices.push_back(vioModel.vertices[idx]);
+            if (have_uvs) {
+                welded.uvs.push_back(vioModel.uvs[idx]);
+            }
+        }
+        stats.vertices_removed = vertices_count - kept.size();
+        vioModel.vertices.swap(welded.vertices);
+        vioModel.uvs.swap(welded.uvs);
+        vioModel.indices.swap(welded.indices);
+        vioModel.face_sizes.swap(welded.face_sizes);
+        return stats;
+    }
+    // only the models with triangles faces and valid indices are optimized
+    static VertexCacheStats m_optimizeModel(Model& vioModel, const uint32_t& vCacheSize, const bool& vOptimizeOverdraw) {
+        VertexCacheStats stats;
+        const size_t vertices_count = vioModel.vertices.size();
+        const bool have_uvs = !vioModel.uvs.empty();
+        if (!vioModel.face_sizes.empty() || vioModel.indices.empty() || (have_uvs && vioModel.uvs.size() != vertices_count)) {
+            return stats;
+        }
+        std::vector<uint32_t> indices(vioModel.indices.size());
+        for (size_t idx = 0U; idx < indices.size(); ++idx) {
+            const int64_t id = (vioModel.indices[idx] < 0) ? (int64_t)vioModel.indices[idx] + (int64_t)vertices_count : vioModel.indices[idx];
+            if (id < 0 || id >= (int64_t)vertices_count) {
+                return stats;
+            }
+            indices[idx] = (uint32_t)id;
+        }
+        std::vector<bool> used(vertices_count, false);
+        for (const auto& id : indices) {
+            stats.vertices_count += used[id] ? 0U : 1U;
+            used[id] = true;
+        }
+        stats.triangles_count = indices.size() / 3U;
+        stats.misses_before = m_getCacheMissesCount(indices, vertices_count, vCacheSize);
+
+        std::vector<size_t> clusters;
+        auto triangles = m_tipsify(indices, vertices_count, vCacheSize, clusters);
+        if (vOptimizeOverdraw) {
+            m_sortClusters(vioModel, indices, clusters, triangles);
+        }
+
+        // the vertices are renumbered in the order of first use, the unused vertices are kept at the end
+        static const uint32_t no_vertex = 0xFFFFFFFFU;
+        std::vector<uint32_t> remap(vertices_count, no_vertex);
+        std::vector<uint32_t> order;
+        order.reserve(vertices_count);
+        std::vector<uint32_t> new_indices(indices.size());
+        for (size_t idx = 0U; idx < triangles.size(); ++idx) {
+            for (size_t c = 0U; c < 3U; ++c) {
+                auto& id = remap[indices[triangles[idx] * 3U + c]];
+                if (id == no_vertex) {
+                    id = (uint32_t)order.size();
+                    order.push_back(indices[triangles[idx] * 3U + c]);
+                }
+                new_indices[idx * 3U + c] = id;
+            }
+        }
+        for (size_t idx = 0U; idx < vertices_count; ++idx) {
+            if (remap[idx] == no_vertex) {
+                order.push_back((uint32_t)idx);
+            }
+        }
+        std::vector<Vertex> vertices(vertices_count);
+        std::vector<UV> uvs(have_uvs ? vertices_count : 0U);
+        for (size_t idx = 0U; idx < vertices_count; ++idx) {
+            vertices[idx] = vioModel.vertices[order[idx]];
+            if (have_uvs) {
+                uvs[idx] = vioModel.uvs[order[idx]];
+            }
+        }
+        vioModel.vertices.swap(vertices);
+        vioModel.uvs.swap(uvs);
+        vioModel.indices.assign(new_indices.begin(), new_indices.end());
+        stats.misses_after = m_getCacheMissesCount(new_indices, vertices_count, vCacheSize);
+        return stats;
+    }
+    // fifo cache simulation
+    static size_t m_getCacheMissesCount(const std::vector<uint32_t>& vIndices, const size_t& vVerticesCount, const uint32_t& vCacheSize) {
+        // time of entry in the cache, 0 for never. an entry stays in the cache for the next vCacheSize misses
+        std::vector<size_t> entry_time(vVerticesCount, 0U);
+        size_t time = vCacheSize + 1U;
+        size_t misses = 0U;
+        for (const auto& id : vIndices) {
+            if (time - entry_time[id] > vCacheSize) {
+                entry_time[id] = time++;
+                ++misses;
+            }
+        }
+        return misses;
+    }
+    // Tipsify from "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw", Sander, Nehab and Barczak, 2007.
+    // the triangles are emitted in fans around a vertex, the next fan vertex is a vertex still in the cache
+    // after its remaining triangles. return the triangles in the new order, and in vOutClusters the start
+    // of each group of triangles following a cache flush
+    static std::vector<size_t> m_tipsify(const std::vector<uint32_t>& vIndices, const size_t& vVerticesCount, const uint32_t& vCacheSize,
+                                         std::vector<size_t>& vOutClusters) {
+        const size_t triangles_count = vIndices.size() / 3U;
+        // triangles of each vertex, from adjacency[adjacency_offsets[v]] to adjacency[adjacency_offsets[v + 1]]
+        std::vector<size_t> adjacency_offsets(vVerticesCount + 1U, 0U);
+        for (const auto& id : vIndices) {
+            ++adjacency_offsets[id + 1U];
+        }
+        for (size_t idx = 0U; idx < vVerticesCount; ++idx) {
+            adjacency_offsets[idx + 1U] += adjacency_offsets[idx];
+        }
+        std::vector<size_t> adjacency(vIndices.size());
+        std::vector<uint32_t> live(vVerticesCount, 0U);  // count of not emitted triangles
+        for (size_t idx = 0U; idx < vIndices.size(); ++idx) {
+            const auto id = vIndices[idx];
+            adjacency[adjacency_offsets[id] + live[id]++] = idx / 3U;
+        }
+        std::vector<size_t> cache_time(vVerticesCount, 0U);
+        std::vector<bool> emitted(triangles_count, false);
+        std::vector<uint32_t> dead_end;
+        std::vector<uint32_t> candidates;
+        std::vector<size_t> res;
+        res.reserve(triangles_count);
+        size_t time = vCacheSize + 1U;
+        size_t cursor = 0U;
+        int64_t fan = vIndices[0];
+        vOutClusters.assign(1U, 0U);
+        while (fan >= 0) {
+            candidates.clear();
+            for (size_t a = adjacency_offsets[(size_t)fan]; a < adjacency_offsets[(size_t)fan + 1U]; ++a) {
+                const auto triangle = adjacency[a];
+                if (emitted[triangle]) {
+                    continue;
+                }
+                emitted[triangle] = true;
+                res.push_back(triangle);
+                for (size_t c = 0U; c < 3U; ++c) {
+                    const auto id = vIndices[triangle * 3U + c];
+                    dead_end.push_back(id);
+                    candidates.push_back(id);
+                    --live[id];
+                    if (time - cache_time[id] > vCacheSize) {
+                        cache_time[id] = time++;
+                    }
+                }
+            }
+            // the candidate still in the cache after the emission of its triangles, with the oldest cache entry
+            fan = -1;
+            int64_t best_priority = -1;
+            for (const auto& id : candidates) {
+                if (live[id] > 0U) {
+                    int64_t priority = 0;
+                    if (time - cache_time[id] + 2U * live[id] <= vCacheSize) {
+                        priority = (int64_t)(time - cache_time[id]);
+                    }
+                    if (priority > best_priority) {
+                        best_priority = priority;
+                        fan = id;
+                    }
+                }
+            }
+            if (fan < 0) {
+                // dead end, a recent vertex with triangles remaining, else the next vertex in the input order
+                while (!dead_end.empty() && fan < 0) {
+                    if (live[dead_end.back()] > 0U) {
+                        fan = dead_end.back();
+                    }
+                    dead_end.pop_back();
+                }
+                while (fan < 0 && cursor < vVerticesCount) {
+                    if (live[cursor] > 0U) {
+                        fan = (int64_t)cursor;
+                    }
+                    ++cursor;
+                }
+                if (fan >= 0 && res.size() < triangles_count) {
+                    vOutClusters.push_back(res.size());
+                }
+            }
+        }
+        return res;
+    }
+    // the clusters are sorted from the most outside facing to the most inside facing, relatively to the model center,
+    // so the front triangles tend to be drawn first
+    static void m_sortClusters(const Model& vModel, const std::vector<uint32_t>& vIndices, const std::vector<size_t>& vClusters,
+                               std::vector<size_t>& vioTriangles) {
+        const size_t clusters_count = vClusters.size();
+        std::vector<std::array<double, 3U>> centers(clusters_count), normals(clusters_count);
+        std::vector<double> areas(clusters_count, 0.0);
+        std::array<double, 3U> model_center = {0.0, 0.0, 0.0};
+        double model_area = 0.0;
+        for (size_t cluster = 0U; cluster < clusters_count; ++cluster) {
+            const auto end = (cluster + 1U < clusters_count) ? vClusters[cluster + 1U] : vioTriangles.size();
+            centers[cluster] = {0.0, 0.0, 0.0};
+            normals[cluster] = {0.0, 0.0, 0.0};
+            for (size_t idx = vClusters[cluster]; idx < end; ++idx) {
+                const auto& p0 = vModel.vertices[vIndices[vioTriangles[idx] * 3U]];
+                const auto& p1 = vModel.vertices[vIndices[vioTriangles[idx] * 3U + 1U]];
+                const auto& p2 = vModel.vertices[vIndices[vioTriangles[idx] * 3U + 2U]];
+                const auto n = m_getTriangleNormal(vModel.vertices, &vIndices[vioTriangles[idx] * 3U]);
+                const double area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]) * 0.5;
+                for (size_t c = 0U; c < 3U; ++c) {
+                    centers[cluster][c] += (p0[c] + p1[c] + p2[c]) / 3.0 * area;
+                    normals[cluster][c] += n[c];
+                    model_center[c] += (p0[c] + p1[c] + p2[c]) / 3.0 * area;
+                }
+                areas[cluster] += area;
+            }
+            model_area += areas[cluster];
+        }
+        if (model_area <= 0.0) {
+            return;
+        }
+        for (size_t c = 0U; c < 3U; ++c) {
+            model_center[c] /= model_area;
+        }
+        std::vector<double> keys(clusters_count, 0.0);
+        for (size_t cluster = 0U; cluster < clusters_count; ++cluster) {
+            if (areas[cluster] > 0.0) {
+                const auto& n = normals[cluster];
+                const double len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                for (size_t c = 0U; c < 3U && len > 0.0; ++c) {
+                    keys[cluster] += (centers[cluster][c] / areas[cluster] - model_center[c]) * n[c] / len;
+                }
+            }
+        }
+        std::vector<size_t> order(clusters_count);
+        for (size_t idx = 0U; idx < clusters_count; ++idx) {
+            order[idx] = idx;
+        }
+        std::stable_sort(order.begin(), order.end(), [&keys](const size_t& a, const size_t& b) { return keys[a] > keys[b]; });
+        std::vector<size_t> triangles;
+        triangles.reserve(vioTriangles.size());
+        for (const auto& cluster : order) {
+            const auto end = (cluster + 1U < clusters_count) ? vClusters[cluster + 1U] : vioTriangles.size();
+            triangles.insert(triangles.end(), vioTriangles.begin() + (std::ptrdiff_t)vClusters[cluster], vioTriangles.begin() + (std::ptrdiff_t)end);
+        }
+        vioTriangles.swap(triangles);
+    }
+    // the identical materials of the models from vFirstModel take the name of the first one, then the models with the same
+    // material, shading and attributes are appended to the first one, their indices rebased. the others stay in their order
+    void m_mergeModels(const size_t& vFirstModel) {
+        std::unordered_map<uint64_t, std::vector<size_t>> materials;  // by hash, the models who give a material
+        size_t materials_count = 0U;
+        for (size_t idx = vFirstModel; idx < m_Models.size(); ++idx) {
+            auto& model = m_Models[idx];
+            auto& candidates = materials[m_getMaterialHash(model.mat)];
+            bool found = false;
+            for (const auto& candidate : candidates) {
+                if (m_isSameMaterial(model.mat, m_Models[candidate].mat)) {
+                    model.mat.name = m_Models[candidate].mat.name;
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                candidates.push_back(idx);
+                ++materials_count;
+            }
+        }
+        std::unordered_map<std::string, size_t> heads;  // by material and attributes, the model receiving the others
+        std::vector<size_t> kept;
+        for (size_t idx = vFirstModel; idx < m_Models.size(); ++idx) {
+            auto& model = m_Models[idx];
+            // the same index is used for the vertex and the uv, so the uvs must be absent or one by vertex
+            const bool mergeable = (model.uvs.empty() || model.uvs.size() == model.vertices.size());
+            const auto key = model.mat.name + '\0' + (model.smooth_shading ? '1' : '0') + (model.uvs.empty() ? '0' : '1') +
+                             (model.normals.empty() ? '0' : '1');
+            auto it = heads.find(key);
+            if (mergeable && it != heads.end() &&
+                m_Models[it->second].vertices.size() + model.vertices.size() <= (size_t)std::numeric_limits<int32_t>::max()) {
+                m_appendModel(m_Models[it->second], model);
+            } else {
+                if (mergeable) {
+                    heads[key] = idx;
+                }
+                kept.push_back(idx);
+            }
+        }
+        const size_t models_count = m_Models.size() - vFirstModel;
+        for (size_t idx = 0U; idx < kept.size(); ++idx) {
+            if (vFirstModel + idx != kept[idx]) {
+                std::swap(m_Models[vFirstModel + idx], m_Models[kept[idx]]);
+            }
+        }
+        m_releaseModels(m_Models, vFirstModel + kept.size());
+        m_log(LogLevel::Info, "Merge : ", models_count, " materials -> ", materials_count, ", ", models_count, " draw calls -> ", kept.size());
+    }
+    // vModel is added at the end of vioModel, the first append make the indices of vioModel absolute
+    static void m_appendModel(Model& vioModel, const Model& vModel) {
+        if (vioModel.parts.empty()) {
+            for (auto& index : vioModel.indices) {
+                if (index < 0) {
+                    index += (int32_t)vioModel.vertices.size();
+                }
+            }
+            Model::Part part;
+            part.name = vioModel.name;
+            part.faces_count = (uint32_t)vioModel.getFacesCount();
+            part.vertices_count = (uint32_t)vioModel.vertices.size();
+            vioModel.parts.push_back(part);
+        }
+        Model::Part part;
+        part.name = vModel.name;
+        part.first_face = (uint32_t)vioModel.getFacesCount();
+        part.faces_count = (uint32_t)vModel.getFacesCount();
+        part.first_vertex = (uint32_t)vioModel.vertices.size();
+        part.vertices_count = (uint32_t)vModel.vertices.size();
+        vioModel.parts.push_back(part);
+        if (!vioModel.face_sizes.empty() || !vModel.face_sizes.empty()) {
+            if (vioModel.face_sizes.empty()) {
+                vioModel.face_sizes.resize(vioModel.indices.size() / 3U, 3U);
+            }
+            if (vModel.face_sizes.empty()) {
+                vioModel.face_sizes.resize(vioModel.face_sizes.size() + vModel.indices.size() / 3U, 3U);
+            } else {
+                vioModel.face_sizes.insert(vioModel.face_sizes.end(), vModel.face_sizes.begin(), vModel.face_sizes.end());
+            }
+        }
+        const auto vertices_offset = (int32_t)vioModel.vertices.size();
+        const auto vertices_count = (int32_t)vModel.vertices.size();
+        vioModel.indices.reserve(vioModel.indices.size() + vModel.indices.size());
+        for (const auto& index : vModel.indices) {
+            vioModel.indices.push_back(((index < 0) ? index + vertices_count : index) + vertices_offset);
+        }
+        vioModel.vertices.insert(vioModel.vertices.end(), vModel.vertices.begin(), vModel.vertices.end());
+        vioModel.uvs.insert(vioModel.uvs.end(), vModel.uvs.begin(), vModel.uvs.end());
+        const auto normals_offset = (uint32_t)vioModel.normals.size();
+        vioModel.normals.insert(vioModel.normals.end(), vModel.normals.begin(), vModel.normals.end());
+        vioModel.normal_indices.reserve(vioModel.normal_indices.size() + vModel.normal_indices.size());
+        for (const auto& index : vModel.normal_indices) {
+            vioModel.normal_indices.push_back(index + normals_offset);
+        }
+    }
+    // hash of the values of the material, not of its name. -0.0 and 0.0 give the same hash
+    static uint64_t m_getMaterialHash(const Material& vMat) {
+        const double values[] = {vMat.Ns + 0.0,    vMat.Ka[0] + 0.0, vMat.Ka[1] + 0.0, vMat.Ka[2] + 0.0, vMat.Ks[0] + 0.0,
+                                 vMat.Ks[1] + 0.0, vMat.Ks[2] + 0.0, vMat.Kd[0] + 0.0, vMat.Kd[1] + 0.0, vMat.Kd[2] + 0.0,
+                                 vMat.Ke[0] + 0.0, vMat.Ke[1] + 0.0, vMat.Ke[2] + 0.0, vMat.Ni + 0.0,    vMat.d + 0.0,
+                                 vMat.illum + 0.0};
+        const auto hash = m_hash64(reinterpret_cast<const char*>(values), sizeof(values), 0U);
+        return m_hash64(vMat.ka_texture.data(), vMat.ka_texture.size(), hash);
+    }
+    static bool m_isSameMaterial(const Material& vA, const Material& vB) {
+        return vA.Ns == vB.Ns && vA.Ka == vB.Ka && vA.Ks == vB.Ks && vA.Kd == vB.Kd && vA.Ke == vB.Ke && vA.Ni == vB.Ni && vA.d == vB.d &&
+               vA.illum == vB.illum && vA.ka_texture == vB.ka_texture;
+    }
+    void m_buildLods(const size_t& vFirstModel) {
+        const size_t levels_count = m_LodRatios.size();
+        m_Lods.resize(levels_count);
+        for (auto& lods : m_Lods) {
+            lods.reserve(m_Models.size());
+            while (lods.size() < m_Models.size()) {
+                lods.push_back(m_getNewModel());
+            }
+        }
+        const size_t count = m_Models.size() - vFirstModel;
+        m_parallelFor(count, [this, vFirstModel](const size_t& vIdx) {
+            std::vector<Model*> lods;
+            for (auto& level : m_Lods) {
+                lods.push_back(&level[vFirstModel + vIdx]);
+            }
+            m_simplifyModel(m_Models[vFirstModel + vIdx], m_LodRatios, lods);
+        });
+        size_t triangles_count = 0U;
+        for (size_t idx = vFirstModel; idx < m_Models.size(); ++idx) {
+            m_forEachTriangle(m_Models[idx], [&triangles_count](const uint32_t&, const uint32_t&, const uint32_t&) { ++triangles_count; });
+        }
+        for (size_t level = 0U; level < levels_count; ++level) {
+            size_t lod_triangles_count = 0U;
+            for (size_t idx = vFirstModel; idx < m_Models.size(); ++idx) {
+                lod_triangles_count += m_Lods[level][idx].indices.size() / 3U;
+            }
+            m_log(LogLevel::Info, "LOD ", level + 1U, " : ", lod_triangles_count, " triangles (",
+                  (triangles_count ? lod_triangles_count * 100U / triangles_count : 0U), "%)");
+            // the locked borders and seams can stop the collapses before the ratio
+            const double ratio = std::max(m_LodRatios[level], 0.0);
+            if ((double)lod_triangles_count > (ratio + 0.01) * (double)triangles_count) {
+                m_log(LogLevel::Info, "LOD ", level + 1U, " : the ratio ", ratio, " is not reached, the borders and the uv seams are kept");
+            }
+        }
+    }
+    // quadric error metrics simplification ("Surface Simplification Using Quadric Error Metrics", Garland and Heckbert, 1997)
+    // with half edge collapses, so the kept vertices keep their position and uv.
+    // the vertices on a border, on an uv seam (same position as another vertex with another uv) or on a non manifold edge are locked.
+    // the lods are made one after the other, from the biggest ratio to the smallest
+    static void m_simplifyModel(const Model& vModel, const std::vector<double>& vRatios, const std::vector<Model*>& vOutLods) {
+        const size_t vertices_count = vModel.vertices.size();
+        const bool have_uvs = (vModel.uvs.size() == vertices_count);
+
+        // the vertices with the same position and uv are merged, the polys of the raw meshes don't share their vertices.
+        // the vertices with the same position but another uv are on a uv seam, they are locked
+        std::vector<bool> locked(vertices_count, false);
+        std::vector<uint32_t> merged(vertices_count);
+        std::vector<uint32_t> by_position(vertices_count);
+        for (size_t idx = 0U; idx < vertices_count; ++idx) {
+            by_position[idx] = (uint32_t)idx;
+        }
+        std::sort(by_position.begin(), by_position.end(), [&vModel, have_uvs](const uint32_t& a, const uint32_t& b) {
+            if (vModel.vertices[a] != vModel.vertices[b]) {
+                return vModel.vertices[a] < vModel.vertices[b];
+            }
+            return have_uvs && vModel.uvs[a] != vModel.uvs[b] ? vModel.uvs[a] < vModel.uvs[b] : a < b;
+        });
+        for (size_t first = 0U, last = 0U; first < vertices_count; first = last) {
+            const auto& position = vModel.vertices[by_position[first]];
+            bool seam = false;
+            for (last = first; last < vertices_count && vModel.vertices[by_position[last]] == position; ++last) {
+                const auto id = by_position[last];
+                if (last > first && have_uvs && vModel.uvs[id] != vModel.uvs[by_position[last - 1U]]) {
+                    seam = true;
+                    merged[id] = id;
+                } else {
+                    merged[id] = (last > first) ? merged[by_position[last - 1U]] : id;
+                }
+            }
+            for (size_t idx = first; seam && idx < last; ++idx) {
+                locked[by_position[idx]] = true;
+            }
+        }
+        std::vector<uint32_t> indices;
+        m_forEachTriangle(vModel, [&indices, &merged](const uint32_t& vIdx0, const uint32_t& vIdx1, const uint32_t& vIdx2) {
+            const uint32_t a = merged[vIdx0];
+            const uint32_t b = merged[vIdx1];
+            const uint32_t c = merged[vIdx2];
+            if (a != b && b != c && c != a) {
+                indices.push_back(a);
+                indices.push_back(b);
+                indices.push_back(c);
+            }
+        });
+        const size_t triangles_count = indices.size() / 3U;
+
+        // the vertices of the borders and of the non manifold edges are locked
+        std::unordered_map<uint64_t, uint32_t> edges_count;
+        edges_count.reserve(indices.size());
+        for (size_t idx = 0U; idx < indices.size(); ++idx) {
+            const uint64_t a = indices[idx];
+            const uint64_t b = indices[idx - idx % 3U + (idx + 1U) % 3U];
+            ++edges_count[(std::min(a, b) << 32U) | std::max(a, b)];
+        }
+        for (const auto& edge : edges_count) {
+            if (edge.second != 2U) {
+                locked[(size_t)(edge.first >> 32U)] = true;
+                locked[(size_t)(edge.first & 0xFFFFFFFFU)] = true;
+            }
+        }
+
+        // quadrics of the planes of the triangles around each vertex, weighted by the triangles areas
+        std::vector<Quadric> quadrics(vertices_count);
+        std::vector<std::vector<uint32_t>> vertex_triangles(vertices_count);
+        for (size_t tri = 0U; tri < triangles_count; ++tri) {
+            const auto n = m_getTriangleNormal(vModel.vertices, &indices[tri * 3U]);
+            const double len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            if (len > 0.0) {
+                const auto& p0 = vModel.vertices[indices[tri * 3U]];
+                const double d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]) / len;
+                for (size_t c = 0U; c < 3U; ++c) {
+                    quadrics[indices[tri * 3U + c]].addPlane(n[0] / len, n[1] / len, n[2] / len, d, len * 0.5);
+                }
+            }
+            for (size_t c = 0U; c < 3U; ++c) {
+                vertex_triangles[indices[tri * 3U + c]].push_back((uint32_t)tri);
+            }
+        }
+
+        std::vector<uint32_t> stamps(vertices_count, 0U);
+        std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> collapses;
+        auto push_collapse = [&](const uint32_t& vFrom, const uint32_t& vTo) {
+            if (!locked[vFrom]) {
+                Collapse collapse;
+                collapse.from = vFrom;
+                collapse.to = vTo;
+                collapse.from_stamp = stamps[vFrom];
+                collapse.to_stamp = stamps[vTo];
+                Quadric quadric = quadrics[vFrom];
+                quadric.add(quadrics[vTo]);
+                collapse.cost = quadric.getError(vModel.vertices[vTo]);
+                collapses.push(collapse);
+            }
+        };
+        for (size_t idx = 0U; idx < indices.size(); ++idx) {
+            const auto a = indices[idx];
+            const auto b = indices[idx - idx % 3U + (idx + 1U) % 3U];
+            push_collapse(a, b);
+            push_collapse(b, a);
+        }
+
+        // the lods from the biggest ratio
+        std::vector<size_t> levels(vRatios.size());
+        for (size_t idx = 0U; idx < levels.size(); ++idx) {
+            levels[idx] = idx;
+        }
+        std::stable_sort(levels.begin(), levels.end(), [&vRatios](const size_t& a, const size_t& b) { return vRatios[a] > vRatios[b]; });
+
+        std::vector<bool> alive(triangles_count, true);
+        std::vector<bool> removed(vertices_count, false);
+        size_t alive_count = triangles_count;
+        std::vector<uint32_t> from_triangles;
+        for (const auto& level : levels) {
+            const auto target = (size_t)(std::max(vRatios[level], 0.0) * (double)triangles_count);
+            while (alive_count > target && !collapses.empty()) {
+                const auto collapse = collapses.top();
+                collapses.pop();
+                const auto from = collapse.from;
+                const auto to = collapse.to;
+                if (removed[from] || removed[to] || stamps[from] != collapse.from_stamp || stamps[to] != collapse.to_stamp) {
+                    continue;  // outdated
+                }
+                // the triangles of from, and no triangle flipped by the collapse
+                from_triangles.clear();
+                bool shared = false;
+                bool flipped = false;
+                for (const auto& tri : vertex_triangles[from]) {
+                    if (!alive[tri]) {
+                        continue;
+                    }
+                    from_triangles.push_back(tri);
+                    const auto* t = &indices[tri * 3U];
+                    if (t[0] == to || t[1] == to || t[2] == to) {
+                        shared = true;
+                        continue;
+                    }
+                    const uint32_t moved[3] = {t[0] == from ? to : t[0], t[1] == from ? to : t[1], t[2] == from ? to : t[2]};
+                    const auto before = m_getTriangleNormal(vModel.vertices, t);
+                    const auto after = m_getTriangleNormal(vModel.vertices, moved);
+                    flipped |= (before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.0);
+                }
+                if (!shared || flipped) {
+                    continue;
+                }
+                auto& to_triangles = vertex_triangles[to];
+                for (const auto& tri : from_triangles) {
+                    auto* t = &indices[tri * 3U];
+                    if (t[0] == to || t[1] == to || t[2] == to) {
+                        alive[tri] = false;
+                        --alive_count;
+                    } else {
+                        for (size_t c = 0U; c < 3U; ++c) {
+                            t[c] = (t[c] == from) ? to : t[c];
+                        }
+                        to_triangles.push_back(tri);
+                    }
+                }
+                to_triangles.erase(std::remove_if(to_triangles.begin(), to_triangles.end(), [&alive](const uint32_t& vTri) { return !alive[vTri]; }),
+                                   to_triangles.end());
+                removed[from] = true;
+                vertex_triangles[from].clear();
+                quadrics[to].add(quadrics[from]);
+                ++stamps[to];
+                for (const auto& tri : to_triangles) {
+                    for (size_t c = 0U; c < 3U; ++c) {
+                        const auto other = indices[tri * 3U + c];
+                        if (other != to) {
+                            push_collapse(to, other);
+                            push_collapse(other, to);
                         }
-                        m_Components.emplace(name);
-                        mesh_found = true;
-                        data_found = false;
-                        uv_found = false;
-                        polys_found = false;
-                        model = {};
-                        model.name = name;
-                        model.mat.name = name;
-                        std::cout << "Mesh found : " << name << std::endl;
                     }
-
-                    start_line = end_line + 1;
-                    end_line = source.find('\n', start_line);
                 }
+            }
 
-                return (!model.vertices.empty() && !model.faces.empty());
+            // the alive triangles with the used vertices
+            auto& lod = *vOutLods[level];
+            lod.name = vModel.name;
+            lod.mat = vModel.mat;
+            lod.smooth_shading = vModel.smooth_shading;
+            static const uint32_t no_vertex = 0xFFFFFFFFU;
+            std::vector<uint32_t> remap(vertices_count, no_vertex);
+            for (size_t tri = 0U; tri < triangles_count; ++tri) {
+                if (alive[tri]) {
+                    for (size_t c = 0U; c < 3U; ++c) {
+                        remap[indices[tri * 3U + c]] = 0U;
+                    }
+                }
+            }
+            for (size_t idx = 0U; idx < vertices_count; ++idx) {
+                if (remap[idx] != no_vertex) {
+                    remap[idx] = (uint32_t)lod.vertices.size();
+                    lod.vertices.push_back(vModel.vertices[idx]);
+                    if (have_uvs) {
+                        lod.uvs.push_back(vModel.uvs[idx]);
+                    }
+                }
+            }
+            lod.indices.reserve(alive_count * 3U);
+            for (size_t tri = 0U; tri < triangles_count; ++tri) {
+                if (alive[tri]) {
+                    lod.addTriangle(remap[indices[tri * 3U]], remap[indices[tri * 3U + 1U]], remap[indices[tri * 3U + 2U]]);
+                }
             }
-        } else {
-            std::cout << "Fail to open the file " << vFile << std::endl;
         }
-        return false;
     }
-
-    bool saveObjFile(const std::string& vFile) {
-        bool res = false;
-        std::string filePathNames[2];  // 0: obj file, 1: mtl file
-        if (vFile.empty()) {
-            filePathNames[0] = m_replaceFileNameExt(m_SourceFilePathName, ".obj");
-            filePathNames[1] = m_replaceFileNameExt(m_SourceFilePathName, ".mtl");
-        } else {
-            filePathNames[0] = m_replaceFileNameExt(vFile, ".obj");
-            filePathNames[1] = m_replaceFileNameExt(vFile, ".mtl");
+    // not normalized, the length is the double of the area
+    static std::array<double, 3U> m_getTriangleNormal(const std::vector<Vertex>& vVertices, const uint32_t* vTriangle) {
+        const auto& p0 = vVertices[vTriangle[0]];
+        const auto& p1 = vVertices[vTriangle[1]];
+        const auto& p2 = vVertices[vTriangle[2]];
+        const double e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+        const double e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+        return {{e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]}};
+    }
+    uint32_t m_getThreadsCount() const {
+        if (m_ThreadsCount) {
+            return m_ThreadsCount;
         }
-
-        ///////////////////////////////////
-        //// write mtl file ///////////////
-        ///////////////////////////////////
-
-        std::string mtl_header = m_toStr(u8R"(# MTL File generated with MdlToObj from a STK/MDL file
-# MdlToObj : https://github.com/aiekick/MdlToObj
-)");
-        auto mtl_file_output = mtl_header;
-        for (const auto& model : m_Models) {
-            mtl_file_output += m_getObjMaterialString(model.mat);
+        const auto count = std::thread::hardware_concurrency();
+        return count ? count : 1U;
+    }
+    // call vFunctor(begin, end) on ranges of [0:vCount[, one range by thread.
+    // a thread for less than 4096 items cost more than he save, so the small counts are not shared
+    template <typename TFunctor>
+    static void m_parallelRanges(const size_t& vCount, const size_t& vThreadsCount, const TFunctor& vFunctor) {
+        const size_t threads_count = std::min<size_t>(vThreadsCount, vCount / 4096U + 1U);
+        if (threads_count <= 1U) {
+            vFunctor(0U, vCount);
+            return;
         }
-        m_saveStringToFile(mtl_file_output, filePathNames[1]);
-
-        ///////////////////////////////////
-        //// write obj file ///////////////
-        ///////////////////////////////////
-
-        std::string obj_header = m_toStr(u8R"(# OBJ File generated with MdlToObj from a STK/MDL file
-# MdlToObj : https://github.com/aiekick/MdlToObj
-)");
-        auto obj_file_output = obj_header;
-        uint32_t vertices_offset = 0U;
-        uint32_t uvs_offset = 0U;
-        for (const auto& model : m_Models) {
-            obj_file_output += m_getObjModelString(model, m_getFileName(filePathNames[1]), vertices_offset, uvs_offset);
-            vertices_offset += (uint32_t)model.vertices.size();
-            uvs_offset += (uint32_t)model.uvs.size();
+        const size_t range = (vCount + threads_count - 1U) / threads_count;
+        std::vector<std::thread> threads;
+        threads.reserve(threads_count - 1U);
+        for (size_t idx = 1U; idx < threads_count; ++idx) {
+            const size_t begin = std::min(idx * range, vCount);
+            const size_t end = std::min(begin + range, vCount);
+            threads.emplace_back([&vFunctor, begin, end]() { vFunctor(begin, end); });
+        }
+        vFunctor(0U, std::min(range, vCount));
+        for (auto& thread : threads) {
+            thread.join();
         }
-        m_saveStringToFile(obj_file_output, filePathNames[0]);
-
-        return res;
     }
-
-private:
-    static std::string m_replaceFileNameExt(const std::string& vFilePathName, const std::string& vNewExt) {
-        assert(!vFilePathName.empty());
-        auto lastDot = vFilePathName.find_last_of('.');
-        if (lastDot == std::string::npos) {
-            return vFilePathName;
+    // call vFunctor(idx) for each idx in [0:vCount[, the indexs are shared between the threads in the ascending order
+    template <typename TFunctor>
+    void m_parallelFor(const size_t& vCount, const TFunctor& vFunctor) const {
+        const size_t threads_count = std::min<size_t>(m_getThreadsCount(), vCount);
+        if (threads_count <= 1U) {
+            for (size_t idx = 0U; idx < vCount; ++idx) {
+                vFunctor(idx);
+            }
+            return;
+        }
+        std::atomic<size_t> next_idx(0U);
+        auto worker = [&next_idx, &vCount, &vFunctor]() {
+            for (size_t idx = next_idx++; idx < vCount; idx = next_idx++) {
+                vFunctor(idx);
+            }
+        };
+        std::vector<std::thread> threads;
+        threads.reserve(threads_count - 1U);
+        for (size_t idx = 1U; idx < threads_count; ++idx) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
         }
-        auto pathWithoutExtension = vFilePathName.substr(0, lastDot);
-        return pathWithoutExtension + vNewExt;
     }
-    static std::string m_getFileName(const std::string& vFilePathName) {
-        assert(!vFilePathName.empty());
-        auto lastSlash = vFilePathName.find_last_of("/\\");
-        if (lastSlash == std::string::npos) {
-            return vFilePathName;
+    // find the PolygonMesh blocks of the file, with the component/surface name who precede them.
+    // the lines of the blocks are passed to m_parseMeshLine without parse the vertices and the faces,
+    // so the blocks end exactly where the full parse will end them.
+    // the blocks already in vioBlocks are overwritten, so their names keep their capacity
+    void m_scanMeshBlocks(const char* vData, const size_t& vSize, std::vector<MeshBlock>& vioBlocks) const {
+        LineLexer lexer(vData, vSize);
+        StrView line;
+        MeshState state;
+        Model scan_model;  // receive the parsed material fields, not used
+        const std::vector<StrView> tokens;  // the vertices and faces lines are not parsed
+        std::vector<int32_t> face_values;
+        std::string component_name;
+        std::string surface_name;
+        size_t blocks_count = 0U;
+        bool mesh_found = false;
+        while (lexer.next(line)) {
+            if (mesh_found) {
+                if (m_parseMeshLine(line, tokens, true, state, scan_model, face_values)) {
+                    mesh_found = false;
+                    auto& block = vioBlocks[blocks_count - 1U];
+                    block.end = lexer.getOffset();
+                    block.ended = true;
+                    block.vertices_count = state.num_verts;
+                    block.faces_count = state.num_faces;
+                }
+                continue;
+            }
+            StrView value;
+            const auto keyword = m_getKeyword(line, value);
+            if (keyword == Keyword::Component) {
+                m_getValue(value, component_name);
+            } else if (keyword == Keyword::Surface) {
+                m_getValue(value, surface_name);
+            } else if (keyword == Keyword::PolygonMesh) {
+                if (blocks_count == vioBlocks.size()) {
+                    vioBlocks.emplace_back();
+                }
+                auto& block = vioBlocks[blocks_count++];
+                block.component = component_name;
+                block.surface = surface_name;
+                mesh_found = true;
+                state.section = MeshSection::Properties;
+                state.uv_found = false;
+                state.num_uvs = 0U;
+                state.num_verts = 0U;
+                state.num_faces = 0U;
+                block.begin = lexer.getOffset();
+                block.end = vSize;
+                block.ended = false;
+                block.vertices_count = 0U;
+                block.faces_count = 0U;
+            }
         }
-        return vFilePathName.substr(lastSlash + 1);
+        vioBlocks.resize(blocks_count);
     }
-    static bool m_isFileExist(const std::string& vFilePathName) {
-        std::ifstream docFile(vFilePathName, std::ios::in);
-        if (docFile.is_open()) {
-            docFile.close();
-            return true;
+    // give to the blocks a name unique in the converter, made of the component and surface names
+    void m_nameMeshBlocks(std::vector<MeshBlock>& vioBlocks) {
+        for (auto& block : vioBlocks) {
+            block.name = m_getUniqueName(block.component, block.surface);
+            m_log(LogLevel::Debug, "Mesh found : ", block.name);
         }
-        return false;
     }
-    static bool m_strToIntT(const std::string& vStr, int32_t& outValue) {
-        try {
-            outValue = std::stoi(vStr);
-            return true;
-        } catch (std::exception& e) {
-            std::cout << e.what() << std::endl;
+    // name of a mesh from its component and surface names, renamed if already used in the converter
+    std::string m_getUniqueName(const std::string& vComponent, const std::string& vSurface) {
+        auto name = vComponent;
+        if (!vSurface.empty() && vSurface != vComponent) {
+            name += "_";
+            name += vSurface;
         }
-        return false;
+        uint32_t idx = 0U;
+        while (m_Components.find(name) != m_Components.end()) {
+            name = m_toStr("%s_%u", vComponent.c_str(), idx++);
+        }
+        m_Components.emplace(name);
+        return name;
     }
-    static bool m_strToSizeT(const std::string& vStr, size_t& outValue) {
-        try {
-            outValue = (size_t)std::stoul(vStr);
-            return true;
-        } catch (std::exception& e) {
-            std::cout << e.what() << std::endl;
+    // the names of the blocks are given back, when the blocks of an outdated index are dropped
+    void m_unnameMeshBlocks(const std::vector<MeshBlock>& vBlocks) {
+        for (const auto& block : vBlocks) {
+            m_Components.erase(block.name);
         }
-        return false;
     }
-    static bool m_strToDouble(const std::string& vStr, double& outValue) {
-        try {
-            outValue = std::stod(vStr);
-            return true;
-        } catch (std::exception& e) {
-            std::cout << e.what() << std::endl;
+    // the blocks matching the component filter
+    void m_selectMeshBlocks(const std::vector<MeshBlock>& vBlocks, std::vector<size_t>& vOutSelected) const {
+        vOutSelected.clear();
+        for (size_t idx = 0U; idx < vBlocks.size(); ++idx) {
+            const auto& block = vBlocks[idx];
+            bool selected = m_ComponentFilter.empty();
+            for (size_t pattern = 0U; pattern < m_ComponentFilter.size() && !selected; ++pattern) {
+                selected = m_isMatching(m_ComponentFilter[pattern], block.component) || m_isMatching(m_ComponentFilter[pattern], block.name);
+            }
+            if (selected) {
+                vOutSelected.push_back(idx);
+            }
         }
-        return false;
     }
-    static bool m_getValueForKey(const std::string& vSrc, const std::string& vKey, std::string& vOutStrValue) {
-        if (!vSrc.empty()) {
-            auto key_pos = vSrc.find(vKey);
-            if (key_pos != std::string::npos) {
-                vOutStrValue = vSrc.substr(key_pos + vKey.size());
-                auto end_line = vOutStrValue.find_first_of("\n\r");
-                if (end_line != std::string::npos) {
-                    vOutStrValue = vOutStrValue.substr(0U, end_line);
-                }
-                return true;
+    // glob matching, * for any chars and ? for one char
+    static bool m_isMatching(const std::string& vPattern, const std::string& vName) {
+        size_t p = 0U;
+        size_t n = 0U;
+        size_t star = std::string::npos;  // position after the last star, and the name position matched by it
+        size_t star_n = 0U;
+        while (n < vName.size()) {
+            if (p < vPattern.size() && (vPattern[p] == '?' || vPattern[p] == vName[n])) {
+                ++p;
+                ++n;
+            } else if (p < vPattern.size() && vPattern[p] == '*') {
+                star = ++p;
+                star_n = n;
+            } else if (star != std::string::npos) {
+                p = star;  // the last star match one more char
+                n = ++star_n;
+            } else {
+                return false;
             }
         }
-        return false;
+        while (p < vPattern.size() && vPattern[p] == '*') {
+            ++p;
+        }
+        return p == vPattern.size();
     }
-    static bool m_getValueForKey(const std::string& vSrc, const std::string& vKey, double& vOutDoubleValue) {
-        std::string strValue;
-        if (m_getValueForKey(vSrc, vKey, strValue)) {
-            return m_strToDouble(strValue, vOutDoubleValue);
+    // the blocks of the mdl text vData, given by the index file if he is valid for the selected blocks, else by the scan.
+    // vOutSelected receive the blocks matching the component filter.
+    // return true if the index file must be saved : missing, outdated, or without bounds while all the blocks are parsed
+    bool m_getMeshBlocks(const char* vData, const size_t& vSize, std::vector<MeshBlock>& vioBlocks, std::vector<size_t>& vOutSelected) {
+        bool have_bounds = false;
+        bool indexed = !m_IndexFilePathName.empty() && m_loadIndex(vSize, vioBlocks, have_bounds);
+        if (indexed) {
+            m_nameMeshBlocks(vioBlocks);
+            m_selectMeshBlocks(vioBlocks, vOutSelected);
+            for (const auto& idx : vOutSelected) {
+                const auto& block = vioBlocks[idx];
+                if (m_hash64(vData + block.begin, block.end - block.begin, 0U) != block.hash) {
+                    m_log(LogLevel::Info, "The index file ", m_IndexFilePathName, " is outdated");
+                    m_unnameMeshBlocks(vioBlocks);
+                    indexed = false;
+                    break;
+                }
+            }
         }
-        return false;
+        if (!indexed) {
+            have_bounds = false;
+            m_scanMeshBlocks(vData, vSize, vioBlocks);
+            m_nameMeshBlocks(vioBlocks);
+            m_selectMeshBlocks(vioBlocks, vOutSelected);
+        }
+        if (vOutSelected.empty() && !vioBlocks.empty()) {
+            m_log(LogLevel::Error, "No component matching the filter in ", m_SourceFilePathName);
+        }
+        return !m_IndexFilePathName.empty() && (!indexed || (!have_bounds && vOutSelected.size() == vioBlocks.size()));
     }
-    static bool m_getValueForKey(const std::string& vSrc, const std::string& vKey, size_t& vOutSizeTValue) {
-        std::string strValue;
-        if (m_getValueForKey(vSrc, vKey, strValue)) {
-            return m_strToSizeT(strValue, vOutSizeTValue);
+    void m_parseMeshBlock(const char* vData, const MeshBlock& vBlock, Model& vOutModel, MeshBuffers& vioBuffers) const {
+        vOutModel.name = vBlock.name;
+        vOutModel.mat.name = vBlock.name;
+        LineLexer lexer(vData + vBlock.begin, vBlock.end - vBlock.begin);
+        StrView line;
+        MeshState state;
+        while (lexer.next(line, &vioBuffers.tokens)) {
+            if (m_parseMeshLine(line, vioBuffers.tokens, false, state, vOutModel, vioBuffers.face_values)) {
+                break;
+            }
         }
-        return false;
     }
-    static bool m_getValueForKey(const std::string& vSrc, const std::string& vKey, Color& vOutColorValue) {
-        std::string strValue;
-        if (m_getValueForKey(vSrc, vKey, strValue)) {
-            double v = 0.0;
-            if (m_strToDouble(strValue.substr(0, 3), v)) {
-                auto r = v / 255.0;
-                if (m_strToDouble(strValue.substr(3, 3), v)) {
-                    auto g = v / 255.0;
-                    if (m_strToDouble(strValue.substr(6), v)) {
-                        auto b = v / 255.0;
-                        vOutColorValue[0] = r;
-                        vOutColorValue[1] = g;
-                        vOutColorValue[2] = b;
-                        return true;
+    // parse a line of a PolygonMesh block, return true on the EndPolygonMesh line.
+    // the directives are recognized in every section, the other lines are the vertices or the faces of their section.
+    // the material directives are ignored in the texture section, where only FRGB is read.
+    // vTokens are the tokens of the line given by the lexer. if vScanOnly, the vertices and faces lines are skipped
+    bool m_parseMeshLine(const StrView& vLine, const std::vector<StrView>& vTokens, const bool& vScanOnly, MeshState& vioState, Model& vioModel,
+                         std::vector<int32_t>& vFaceValues) const {
+        auto& model = vioModel;
+        const bool in_texture = (vioState.section == MeshSection::Texture);
+        StrView value;
+        switch (m_getKeyword(vLine, value)) {
+            case Keyword::None: {
+                if (vioState.section == MeshSection::Vertices) {
+                    if (vScanOnly) {
+                        if (vioState.uv_found) {
+                            ++vioState.num_uvs;
+                        }
+                    } else if (vioState.uv_found) {
+                        Vertex vertex;
+                        UV uv;
+                        if (m_getVertexUV(vTokens, vertex, uv)) {
+                            model.vertices.push_back(vertex);
+                            model.uvs.push_back(uv);
+                        }
+                    } else {
+                        Vertex vertex;
+                        if (m_getVertex(vTokens, vertex)) {
+                            model.vertices.push_back(vertex);
+                        }
+                    }
+                } else if (vioState.section == MeshSection::Faces) {
+                    if (!vScanOnly) {
+                        m_getFaces(vTokens, vFaceValues, model);
+                    }
+                }
+            } break;
+            case Keyword::EndPolygonMesh: {
+                if (vScanOnly) {
+                    if (vioState.num_verts) {
+                        m_log(LogLevel::Debug, "Count Vertex : ", vioState.num_verts);
+                    }
+                    if (vioState.num_uvs) {
+                        m_log(LogLevel::Debug, "Count Uvs : ", vioState.num_uvs);
+                    }
+                    if (vioState.num_faces) {
+                        m_log(LogLevel::Debug, "Count Faces : ", vioState.num_faces);
                     }
                 }
+                vioState.section = MeshSection::Properties;
+                return true;
             }
+            case Keyword::NumVerts: {
+                if (m_getValue(value, vioState.num_verts) && !vScanOnly) {
+                    model.vertices.reserve(vioState.num_verts);  // for speed up next push_back
+                }
+            } break;
+            case Keyword::NumPolys: {
+                if (m_getValue(value, vioState.num_faces)) {
+                    if (vioState.section == MeshSection::Vertices) {
+                        vioState.section = MeshSection::Properties;
+                    }
+                    if (vScanOnly) {
+                        m_log(LogLevel::Debug, "Faces section found");
+                    } else {
+                        model.indices.reserve(vioState.num_faces * 3U);  // for speed up next push_back
+                    }
+                }
+            } break;
+            case Keyword::Data: {
+                vioState.section = MeshSection::Vertices;
+                vioState.uv_found = false;
+                if (vScanOnly) {
+                    m_log(LogLevel::Debug, "Vertices section found");
+                }
+            } break;
+            case Keyword::DataTx: {
+                vioState.section = MeshSection::Vertices;
+                vioState.uv_found = true;
+                if (vScanOnly) {
+                    m_log(LogLevel::Debug, "Vertices/Uvs section found");
+                }
+            } break;
+            case Keyword::Polys: {
+                vioState.section = MeshSection::Faces;
+            } break;
+            case Keyword::Texture: {
+                vioState.section = MeshSection::Texture;
+            } break;
+            case Keyword::EndTexture: {
+                if (in_texture) {
+                    vioState.section = MeshSection::Properties;
+                }
+            } break;
+            case Keyword::FRGB: {
+                if (in_texture && m_getValue(value, model.mat.ka_texture) && vScanOnly) {
+                    m_log(LogLevel::Debug, "Ka texture found : ", model.mat.ka_texture);
+                }
+            } break;
+            case Keyword::FaceColor: {
+                if (!in_texture) {
+                    m_getValue(value, model.mat.Ka);
+                }
+            } break;
+            case Keyword::FaceEmissionColor: {
+                if (!in_texture) {
+                    m_getValue(value, model.mat.Ke);
+                }
+            } break;
+            case Keyword::SmoothShading: {
+                if (!in_texture && m_getValue(value, vioState.smooth_shading)) {
+                    model.smooth_shading = (vioState.smooth_shading != "No");
+                }
+            } break;
+            case Keyword::Shininess: {
+                if (!in_texture) {
+                    m_getValue(value, model.mat.Ns);
+                }
+            } break;
+            case Keyword::Translucency: {
+                if (!in_texture) {
+                    m_getValue(value, model.mat.d);
+                }
+            } break;
+            case Keyword::Specularity: {
+                if (!in_texture && m_getValue(value, model.mat.Ks[0])) {
+                    model.mat.Ks[1] = model.mat.Ks[0];
+                    model.mat.Ks[2] = model.mat.Ks[0];
+                }
+            } break;
+            default: break;  // Component, Surface and PolygonMesh are not expected in a block
         }
         return false;
     }
-    static bool m_isKeyExist(const std::string& vSrc, const std::string& vKey) {
-        if (!vSrc.empty()) {
-            return (vSrc.find(vKey) != std::string::npos);
+    // status of the number parsing functions
+    enum class NumberStatus { Ok = 0, Invalid, OutOfRange };
+    static bool m_isDigit(const char& vChar) {
+        return (vChar >= '0' && vChar <= '9');
+    }
+    // parse a signed integer at the start of [vBegin:vEnd[
+    // like std::stoi, the parsing stop at the first char who is not a digit
+    static NumberStatus m_parseInt(const char* vBegin, const char* vEnd, int32_t& vOutValue, const char** vOutEnd = nullptr) {
+        const char* cur = vBegin;
+        bool negative = false;
+        if (cur != vEnd && (*cur == '-' || *cur == '+')) {
+            negative = (*cur == '-');
+            ++cur;
         }
-        return false;
+        if (cur == vEnd || !m_isDigit(*cur)) {
+            return NumberStatus::Invalid;
+        }
+        const int64_t limit = negative ? -(int64_t)INT32_MIN : (int64_t)INT32_MAX;
+        int64_t value = 0;
+        while (cur != vEnd && m_isDigit(*cur)) {
+            value = value * 10 + (*cur - '0');
+            if (value > limit) {
+                return NumberStatus::OutOfRange;
+            }
+            ++cur;
+        }
+        vOutValue = (int32_t)(negative ? -value : value);
+        if (vOutEnd != nullptr) {
+            *vOutEnd = cur;
+        }
+        return NumberStatus::Ok;
     }
-    static bool m_replaceString(::std::string& str, const ::std::string& oldStr, const ::std::string& newStr) {
-        bool found = false;
-        size_t pos = 0;
-        while ((pos = str.find(oldStr, pos)) != ::std::string::npos) {
-            found = true;
-            str.replace(pos, oldStr.length(), newStr);
-            pos += newStr.length();
+    // parse an unsigned integer at the start of [vBegin:vEnd[
+    static NumberStatus m_parseSizeT(const char* vBegin, const char* vEnd, size_t& vOutValue, const char** vOutEnd = nullptr) {
+        const char* cur = vBegin;
+        if (cur != vEnd && *cur == '+') {
+            ++cur;
+        }
+        if (cur == vEnd || !m_isDigit(*cur)) {
+            return NumberStatus::Invalid;
         }
-        return found;
+        size_t value = 0U;
+        while (cur != vEnd && m_isDigit(*cur)) {
+            const auto digit = (size_t)(*cur - '0');
+            if (value > (SIZE_MAX - digit) / 10U) {
+                return NumberStatus::OutOfRange;
+            }
+            value = value * 10U + digit;
+            ++cur;
+        }
+        vOutValue = value;
+        if (vOutEnd != nullptr) {
+            *vOutEnd = cur;
+        }
+        return NumberStatus::Ok;
     }
-    static std::vector<std::string> m_splitStringToVector(const std::string& vText, const std::string& vDelimiters, const bool& vPushEmpty) {
-        std::vector<std::string> arr;
-        if (!vText.empty()) {
-            size_t start = 0;
-            size_t end = vText.find_first_of(vDelimiters, start);
-            while (end != std::string::npos) {
-                std::string token = vText.substr(start, end - start);
-                if (!token.empty() || (token.empty() && vPushEmpty)) {
-                    arr.emplace_back(token);
+    // parse a double at the start of [vBegin:vEnd[, with the same result as std::stod
+    // the decimal separator is always '.', whatever the current locale
+    // the common case (at most 19 significant digits, exponent in [-22:22], mantissa < 2^53)
+    // is exact with only one multiplication or division, since both operands are exact doubles.
+    // the rare other cases are sent to strtod, without allocation
+    static NumberStatus m_parseDouble(const char* vBegin, const char* vEnd, double& vOutValue, const char** vOutEnd = nullptr) {
+        static const double s_pow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                         1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+        const char* cur = vBegin;
+        bool negative = false;
+        if (cur != vEnd && (*cur == '-' || *cur == '+')) {
+            negative = (*cur == '-');
+            ++cur;
+        }
+        uint64_t mantissa = 0U;
+        int32_t count_digits = 0;      // significant digits stored in mantissa
+        int32_t exponent = 0;          // base 10 exponent to apply on mantissa
+        bool have_digits = false;
+        bool truncated = false;        // more than 19 significant digits
+        while (cur != vEnd && m_isDigit(*cur)) {
+            have_digits = true;
+            if (count_digits < 19) {
+                mantissa = mantissa * 10U + (uint64_t)(*cur - '0');
+                if (mantissa) {
+                    ++count_digits;
                 }
-                start = end + 1;
-                end = vText.find_first_of(vDelimiters, start);
-            }
-            std::string token = vText.substr(start);
-            if (!token.empty() || (token.empty() && vPushEmpty)) {
-                arr.emplace_back(token);
+            } else {
+                truncated |= (*cur != '0');
+                ++exponent;
             }
+            ++cur;
         }
-        return arr;
-    }
-    static std::vector<int32_t> m_splitStringToIntVector(const std::string& vText, const std::string& vDelimiters, const bool& vPushEmpty) {
-        std::vector<int32_t> arr;
-        int32_t tmp;
-        if (!vText.empty()) {
-            size_t start = 0;
-            size_t end = vText.find_first_of(vDelimiters, start);
-            while (end != std::string::npos) {
-                std::string token = vText.substr(start, end - start);
-                if (!token.empty() || (token.empty() && vPushEmpty)) {
-                    if (m_strToIntT(token, tmp)) {
-                        arr.emplace_back(tmp);
+        if (cur != vEnd && *cur == '.') {
+            ++cur;
+            while (cur != vEnd && m_isDigit(*cur)) {
+                have_digits = true;
+                if (count_digits < 19) {
+                    mantissa = mantissa * 10U + (uint64_t)(*cur - '0');
+                    if (mantissa) {
+                        ++count_digits;
                     }
+                    --exponent;
+                } else {
+                    truncated |= (*cur != '0');
                 }
-                start = end + 1;
-                end = vText.find_first_of(vDelimiters, start);
+                ++cur;
             }
-            std::string token = vText.substr(start);
-            if (!token.empty() || (token.empty() && vPushEmpty)) {
-                if (m_strToIntT(token, tmp)) {
-                    arr.emplace_back(tmp);
+        }
+        if (!have_digits) {
+            return m_parseDoubleSlow(vBegin, vEnd, vOutValue, vOutEnd);  // inf, nan
+        }
+        if (cur != vEnd && (*cur == 'e' || *cur == 'E')) {
+            const char* exp_end = nullptr;
+            int32_t exp_value = 0;
+            const auto status = m_parseInt(cur + 1, vEnd, exp_value, &exp_end);
+            if (status == NumberStatus::OutOfRange) {
+                return m_parseDoubleSlow(vBegin, vEnd, vOutValue, vOutEnd);
+            } else if (status == NumberStatus::Ok) {
+                if ((exponent > 0 && exp_value > INT32_MAX - exponent) ||  //
+                    (exponent < 0 && exp_value < INT32_MIN - exponent)) {
+                    return m_parseDoubleSlow(vBegin, vEnd, vOutValue, vOutEnd);
                 }
+                exponent += exp_value;
+                cur = exp_end;
+            }  // else the 'e' is not part of the number, like strtod
+        }
+        if (truncated || mantissa > (1ULL << 53U) || exponent < -22 || exponent > 22) {
+            return m_parseDoubleSlow(vBegin, cur, vOutValue, vOutEnd);
+        }
+        double value = (double)mantissa;
+        if (exponent < 0) {
+            value /= s_pow10[-exponent];
+        } else {
+            value *= s_pow10[exponent];
+        }
+        vOutValue = negative ? -value : value;
+        if (vOutEnd != nullptr) {
+            *vOutEnd = cur;
+        }
+        return NumberStatus::Ok;
+    }
+    static NumberStatus m_parseDoubleSlow(const char* vBegin, const char* vEnd, double& vOutValue, const char** vOutEnd) {
+        // strtod need a zero terminated string, and use the decimal point of the current locale
+        char buffer[128];
+        const auto len = (size_t)(vEnd - vBegin) < sizeof(buffer) - 1U ? (size_t)(vEnd - vBegin) : sizeof(buffer) - 1U;
+        memcpy(buffer, vBegin, len);
+        buffer[len] = '\0';
+        const char locale_point = *localeconv()->decimal_point;
+        if (locale_point != '.') {
+            auto point = static_cast<char*>(memchr(buffer, '.', len));
+            if (point != nullptr) {
+                *point = locale_point;
             }
         }
-        return arr;
+        char* end = nullptr;
+        errno = 0;
+        const double value = strtod(buffer, &end);
+        if (end == buffer) {
+            return NumberStatus::Invalid;
+        }
+        if (errno == ERANGE) {
+            return NumberStatus::OutOfRange;
+        }
+        vOutValue = value;
+        if (vOutEnd != nullptr) {
+            *vOutEnd = vBegin + (end - buffer);
+        }
+        return NumberStatus::Ok;
     }
-    static bool m_getVertex(const std::string& vSrc, Vertex& vOutVertexValue) {
-        if (!vSrc.empty()) {
-            auto tokens = m_splitStringToVector(vSrc, " ", false);
-            if (tokens.size() == 3U) {
-                if (m_strToDouble(tokens[0], vOutVertexValue[0])) {
-                    if (m_strToDouble(tokens[1], vOutVertexValue[1])) {
-                        if (m_strToDouble(tokens[2], vOutVertexValue[2])) {
-                            return true;
-                        }
-                    }
-                }
+    static bool m_isBlank(const char& vChar) {
+        return (vChar == ' ' || vChar == '\t' || vChar == '\r');
+    }
+    // get the next blank separated token of vSrc starting at vioPos
+    // the whitespace normalization is done here, so the line is never modified or copied
+    static bool m_getNextToken(const StrView& vSrc, size_t& vioPos, StrView& vOutToken) {
+        while (vioPos < vSrc.size && m_isBlank(vSrc.ptr[vioPos])) {
+            ++vioPos;
+        }
+        if (vioPos < vSrc.size) {
+            const auto start = vioPos;
+            while (vioPos < vSrc.size && !m_isBlank(vSrc.ptr[vioPos])) {
+                ++vioPos;
             }
+            vOutToken = StrView(vSrc.ptr + start, vioPos - start);
+            return true;
         }
         return false;
     }
-    static bool m_getVertexUV(const std::string& vSrc, Vertex& vOutVertexValue, UV& vOutUVValue) {
-        if (!vSrc.empty()) {
-            auto tokens = m_splitStringToVector(vSrc, " ", false);
-            if (tokens.size() == 5U) {
-                if (m_strToDouble(tokens[0], vOutVertexValue[0])) {
-                    if (m_strToDouble(tokens[1], vOutVertexValue[1])) {
-                        if (m_strToDouble(tokens[2], vOutVertexValue[2])) {
-                            if (m_strToDouble(tokens[3], vOutUVValue[0])) {
-                                if (m_strToDouble(tokens[4], vOutUVValue[1])) {
-                                    return true;
-                                }
-                            }
-                        }
-                    }
+    static bool m_viewToDouble(const StrView& vSrc, double& outValue) {
+        return (m_parseDouble(vSrc.begin(), vSrc.end(), outValue) == NumberStatus::Ok);
+    }
+    static bool m_viewToIntT(const StrView& vSrc, int32_t& outValue) {
+        return (m_parseInt(vSrc.begin(), vSrc.end(), outValue) == NumberStatus::Ok);
+    }
+    static bool m_viewToSizeT(const StrView& vSrc, size_t& outValue) {
+        return (m_parseSizeT(vSrc.begin(), vSrc.end(), outValue) == NumberStatus::Ok);
+    }
+    // fnv-1a hash of the keywords, computed at compile time for the case labels,
+    // so two keywords with the same hash are a compile error
+    static constexpr uint32_t m_hashKeyword(const char* vStr, const uint32_t vHash = 2166136261U) {
+        return (*vStr != 0) ? m_hashKeyword(vStr + 1, (vHash ^ (uint8_t)*vStr) * 16777619U) : vHash;
+    }
+    static uint32_t m_hashKeyword(const StrView& vToken) {
+        uint32_t hash = 2166136261U;
+        for (const auto& c : vToken) {
+            hash = (hash ^ (uint8_t)c) * 16777619U;
+        }
+        return hash;
+    }
+    // a word with the hash of a keyword is not always the keyword
+    template <size_t N>
+    static Keyword m_checkKeyword(const StrView& vToken, const char (&vName)[N], const Keyword& vKeyword) {
+        if (vToken.size == N - 1U && memcmp(vToken.ptr, vName, N - 1U) == 0) {
+            return vKeyword;
+        }
+        return Keyword::None;
+    }
+    // the keyword given by the first token of vLine, and the value who follow the keyword and its separator.
+    // the line is read once, the value is parsed by m_getValue
+    static Keyword m_getKeyword(const StrView& vLine, StrView& vOutValue) {
+        size_t pos = 0U;
+        while (pos < vLine.size && m_isBlank(vLine.ptr[pos])) {
+            ++pos;
+        }
+        // the vertices and faces lines start by a number, they are the most of the lines
+        if (pos == vLine.size || !(vLine.ptr[pos] == '#' || ((vLine.ptr[pos] | 0x20) >= 'a' && (vLine.ptr[pos] | 0x20) <= 'z'))) {
+            return Keyword::None;
+        }
+        StrView token;
+        m_getNextToken(vLine, pos, token);
+        auto keyword = Keyword::None;
+        if (token.ptr[0] == '#') {
+            // the only comment read is "# Surface: name"
+            if (token.size > 1U) {
+                token = token.substr(1U);
+            } else if (!m_getNextToken(vLine, pos, token)) {
+                return Keyword::None;
+            }
+            keyword = m_checkKeyword(token, "Surface:", Keyword::Surface);
+        } else {
+            switch (m_hashKeyword(token)) {
+                case m_hashKeyword("Component"): keyword = m_checkKeyword(token, "Component", Keyword::Component); break;
+                case m_hashKeyword("PolygonMesh"): keyword = m_checkKeyword(token, "PolygonMesh", Keyword::PolygonMesh); break;
+                case m_hashKeyword("EndPolygonMesh"): keyword = m_checkKeyword(token, "EndPolygonMesh", Keyword::EndPolygonMesh); break;
+                case m_hashKeyword("NumVerts"): keyword = m_checkKeyword(token, "NumVerts", Keyword::NumVerts); break;
+                case m_hashKeyword("NumPolys"): keyword = m_checkKeyword(token, "NumPolys", Keyword::NumPolys); break;
+                case m_hashKeyword("Data"): keyword = m_checkKeyword(token, "Data", Keyword::Data); break;
+                case m_hashKeyword("DataTx"): keyword = m_checkKeyword(token, "DataTx", Keyword::DataTx); break;
+                case m_hashKeyword("Polys"): keyword = m_checkKeyword(token, "Polys", Keyword::Polys); break;
+                case m_hashKeyword("Texture"): keyword = m_checkKeyword(token, "Texture", Keyword::Texture); break;
+                case m_hashKeyword("EndTexture"): keyword = m_checkKeyword(token, "EndTexture", Keyword::EndTexture); break;
+                case m_hashKeyword("FRGB"): keyword = m_checkKeyword(token, "FRGB", Keyword::FRGB); break;
+                case m_hashKeyword("FaceColor"): keyword = m_checkKeyword(token, "FaceColor", Keyword::FaceColor); break;
+                case m_hashKeyword("FaceEmissionColor"): keyword = m_checkKeyword(token, "FaceEmissionColor", Keyword::FaceEmissionColor); break;
+                case m_hashKeyword("SmoothShading"): keyword = m_checkKeyword(token, "SmoothShading", Keyword::SmoothShading); break;
+                case m_hashKeyword("Shininess"): keyword = m_checkKeyword(token, "Shininess", Keyword::Shininess); break;
+                case m_hashKeyword("Translucency"): keyword = m_checkKeyword(token, "Translucency", Keyword::Translucency); break;
+                case m_hashKeyword("Specularity"): keyword = m_checkKeyword(token, "Specularity", Keyword::Specularity); break;
+                default: break;
+            }
+        }
+        if (keyword != Keyword::None) {
+            // the value start after the blank who follow the keyword
+            pos = (size_t)(token.end() - vLine.begin());
+            vOutValue = (pos < vLine.size) ? vLine.substr(pos + 1U) : StrView();
+        }
+        return keyword;
+    }
+    static bool m_getValue(const StrView& vValue, std::string& vOutStrValue) {
+        if (vValue.empty()) {
+            return false;
+        }
+        // tabs and carriage returns are not part of the value
+        vOutStrValue.clear();
+        for (const auto& c : vValue) {
+            if (c != '\t' && c != '\r') {
+                vOutStrValue += c;
+            }
+        }
+        return true;
+    }
+    static bool m_getValue(const StrView& vValue, double& vOutDoubleValue) {
+        size_t pos = 0U;
+        StrView token;
+        if (m_getNextToken(vValue, pos, token)) {
+            return m_viewToDouble(token, vOutDoubleValue);
+        }
+        return false;
+    }
+    static bool m_getValue(const StrView& vValue, size_t& vOutSizeTValue) {
+        size_t pos = 0U;
+        StrView token;
+        if (m_getNextToken(vValue, pos, token)) {
+            return m_viewToSizeT(token, vOutSizeTValue);
+        }
+        return false;
+    }
+    static bool m_getValue(const StrView& vValue, Color& vOutColorValue) {
+        // %RRRGGGBBB
+        if (vValue.empty() || vValue.ptr[0] != '%') {
+            return false;
+        }
+        const auto value = vValue.substr(1U);
+        double v = 0.0;
+        if (m_viewToDouble(value.substr(0, 3), v)) {
+            auto r = v / 255.0;
+            if (m_viewToDouble(value.substr(3, 3), v)) {
+                auto g = v / 255.0;
+                if (m_viewToDouble(value.substr(6), v)) {
+                    auto b = v / 255.0;
+                    vOutColorValue[0] = r;
+                    vOutColorValue[1] = g;
+                    vOutColorValue[2] = b;
+                    return true;
                 }
             }
         }
         return false;
     }
-    static bool m_getFaces(const std::string& vSrc, std::vector<Face>& vOutFacesValue) {
-        if (!vSrc.empty()) {
+    // fill vOutValues with the ints of vTokens, the unparsable tokens are skipped
+    static void m_getInts(const std::vector<StrView>& vTokens, std::vector<int32_t>& vOutValues) {
+        vOutValues.clear();
+        int32_t tmp;
+        for (const auto& token : vTokens) {
+            if (m_viewToIntT(token, tmp)) {
+                vOutValues.push_back(tmp);
+            }
+        }
+    }
+    template <size_t N>
+    static bool m_getDoubles(const std::vector<StrView>& vTokens, const size_t& vFirst, std::array<double, N>& vOutValues) {
+        for (size_t idx = 0U; idx < N; ++idx) {
+            if (!m_viewToDouble(vTokens[vFirst + idx], vOutValues[idx])) {
+                return false;
+            }
+        }
+        return true;
+    }
+    static bool m_getVertex(const std::vector<StrView>& vTokens, Vertex& vOutVertexValue) {
+        return (vTokens.size() == 3U && m_getDoubles(vTokens, 0U, vOutVertexValue));
+    }
+    static bool m_getVertexUV(const std::vector<StrView>& vTokens, Vertex& vOutVertexValue, UV& vOutUVValue) {
+        return (vTokens.size() == 5U && m_getDoubles(vTokens, 0U, vOutVertexValue) && m_getDoubles(vTokens, 3U, vOutUVValue));
+    }
+    static bool m_getFaces(const std::vector<StrView>& vTokens, std::vector<int32_t>& vValues, Model& vOutModel) {
+        if (!vTokens.empty()) {
             // [-1] N i0 i1 i2 i3 i4 i5 i6 ...
 			// -1 => triangle strip / nothing => triangle fan
             // N => count faces
-            auto tokens = m_splitStringToIntVector(vSrc, " ", false);
+            m_getInts(vTokens, vValues);
+            const auto& tokens = vValues;
             if (!tokens.empty()) {
                 int32_t offset = 1;
                 int32_t mode = 1; // triangle fan
@@ -468,7 +4880,6 @@ private:
                     count_faces = tokens[0];
                 }
                 if (count_faces == ((int32_t)tokens.size() - offset)) {  // check than face is ok
-                    Face face;
                     size_t count = tokens.size() - 1U;
                     size_t face_id = 0U;
                     for (size_t idx = offset + 1U; idx < count; ++idx) {
@@ -482,11 +4893,7 @@ private:
                             * f0 [0 1 2]
                             * f1 [0 2 3]
                             */
-                            face.push_back(tokens[offset]);
-                            face.push_back(tokens[idx]);
-                            face.push_back(tokens[idx + 1]);
-                            vOutFacesValue.push_back(face);
-                            face.clear();
+                            vOutModel.addTriangle(tokens[offset], tokens[idx], tokens[idx + 1]);
                         } else /*if (mode == -1)*/ {  // triangle strip
                             /*
                             * [0 1 3 2 5 4 7] :
@@ -501,18 +4908,10 @@ private:
                             * f4 [5 4 7]
                             */
                             if (face_id && (face_id + 1U) % 2U == 0) {
-                                face.push_back(tokens[idx - 1]);
-                                face.push_back(tokens[idx + 1]);
-                                face.push_back(tokens[idx]);
-                                vOutFacesValue.push_back(face);
-                                face.clear();
+                                vOutModel.addTriangle(tokens[idx - 1], tokens[idx + 1], tokens[idx]);
                                 ++face_id;
                             } else {
-                                face.push_back(tokens[idx - 1]);
-                                face.push_back(tokens[idx]);
-                                face.push_back(tokens[idx + 1]);
-                                vOutFacesValue.push_back(face);
-                                face.clear();
+                                vOutModel.addTriangle(tokens[idx - 1], tokens[idx], tokens[idx + 1]);
                                 ++face_id;
                             }
                         }
@@ -523,24 +4922,6 @@ private:
         }
         return false;
     }
-    static std::string m_loadFileToString(const std::string& vFile) {
-        std::string res;
-        std::ifstream docFile(vFile, std::ios::in);
-        if (docFile.is_open()) {
-            std::stringstream strStream;
-            strStream << docFile.rdbuf();  // read the file
-            res = strStream.str();
-            docFile.close();
-        }
-        return res;
-    }
-    static void m_saveStringToFile(const std::string& vString, const std::string& vFilePathName) {
-        std::ofstream fileWriter(vFilePathName, std::ios::out);
-        if (!fileWriter.bad()) {
-            fileWriter << vString;
-            fileWriter.close();
-        }
-    }
     static std::string m_toStr(const char* fmt, ...) {
         va_list args;
         va_start(args, fmt);
@@ -552,33 +4933,91 @@ private:
         }
         return std::string{};
     }
-    static std::string m_getObjMaterialString(const Material& vMaterial) {
-        auto res = m_toStr(u8R"(
-newmtl %s
-Ns %.6f
-Ka %.6f %.6f %.6f
-Kd %.6f %.6f %.6f
-Ks %.6f %.6f %.6f
-Ke %.6f %.6f %.6f
-Ni %.6f
-d %.6f
-illum %u
-)",
-                         vMaterial.name.c_str(),                             //
-                         vMaterial.Ns,                                       //
-                         vMaterial.Ka[0], vMaterial.Ka[1], vMaterial.Ka[2],  //
-                         vMaterial.Kd[0], vMaterial.Kd[1], vMaterial.Kd[2],  //
-                         vMaterial.Ks[0], vMaterial.Ks[1], vMaterial.Ks[2],  //
-                         vMaterial.Ke[0], vMaterial.Ke[1], vMaterial.Ke[2],  //
-                         vMaterial.Ni,                                       //
-                         vMaterial.d,                                        //
-                         (uint32_t)vMaterial.illum);                         //
+    // max size written by m_formatFixed6, with the sign and the trailing zero of the snprintf fallback
+    static const size_t s_MaxFixed6Size = 330U;
+    static size_t m_formatUInt(char* vBuffer, uint64_t vValue) {
+        char tmp[20];
+        size_t len = 0U;
+        do {
+            tmp[len++] = (char)('0' + (vValue % 10U));
+            vValue /= 10U;
+        } while (vValue);
+        for (size_t i = 0U; i < len; ++i) {
+            vBuffer[i] = tmp[len - 1U - i];
+        }
+        return len;
+    }
+    static size_t m_formatInt(char* vBuffer, const int32_t& vValue) {
+        if (vValue < 0) {
+            vBuffer[0] = '-';
+            return 1U + m_formatUInt(vBuffer + 1, (uint64_t)(-(int64_t)vValue));
+        }
+        return m_formatUInt(vBuffer, (uint64_t)vValue);
+    }
+    // format vValue like printf("%.6f"), byte for byte.
+    // the value is scaled by 1e6 and rounded to the nearest integer (ties to even) from its exact value :
+    // the product is exact with its error term (Dekker), so only an exact tie need to look at this error.
+    // values out of [-4e9:4e9], inf and nan are sent to snprintf
+    static size_t m_formatFixed6(char* vBuffer, const double& vValue) {
+        double a = std::fabs(vValue);
+        if (!(a < 4e9)) {
+            return (size_t)snprintf(vBuffer, s_MaxFixed6Size, "%.6f", vValue);
+        }
+        const double scale = 1e6;  // 1e6 have only 20 significant bits, so the low part of its split is zero
+        const double y = a * scale;
+        const double split = 134217729.0 * a;  // 2^27 + 1
+        const double a_hi = split - (split - a);
+        const double a_lo = a - a_hi;
+        const double err = (a_hi * scale - y) + a_lo * scale;  // a * 1e6 == y + err exactly
+        const double r = std::floor(y);
+        const double t = y - r;
+        auto n = (uint64_t)r;
+        if (t > 0.5 || (t == 0.5 && (err > 0.0 || (err == 0.0 && (n & 1U))))) {
+            ++n;
+        }
+        size_t len = 0U;
+        if (std::signbit(vValue)) {
+            vBuffer[len++] = '-';
+        }
+        len += m_formatUInt(vBuffer + len, n / 1000000U);
+        vBuffer[len++] = '.';
+        auto frac = (uint32_t)(n % 1000000U);
+        for (size_t i = 6U; i > 0U; --i) {
+            vBuffer[len + i - 1U] = (char)('0' + frac % 10U);
+            frac /= 10U;
+        }
+        return len + 6U;
+    }
+    static void m_writeObjMaterial(TextWriter& vWriter, const Material& vMaterial) {
+        vWriter.write("\nnewmtl ");
+        vWriter.write(vMaterial.name);
+        vWriter.write("\nNs ");
+        vWriter.writeFixed6(vMaterial.Ns);
+        m_writeColor(vWriter, "\nKa ", vMaterial.Ka);
+        m_writeColor(vWriter, "\nKd ", vMaterial.Kd);
+        m_writeColor(vWriter, "\nKs ", vMaterial.Ks);
+        m_writeColor(vWriter, "\nKe ", vMaterial.Ke);
+        vWriter.write("\nNi ");
+        vWriter.writeFixed6(vMaterial.Ni);
+        vWriter.write("\nd ");
+        vWriter.writeFixed6(vMaterial.d);
+        vWriter.write("\nillum ");
+        vWriter.writeUInt((uint32_t)vMaterial.illum);
+        vWriter.write('\n');
         if (!vMaterial.ka_texture.empty()) {
-            res += m_toStr(u8R"(map_Ka %s\n
-)",
-                         vMaterial.ka_texture.c_str());
+            vWriter.write("map_Ka ");
+            vWriter.write(vMaterial.ka_texture);
+            vWriter.write("\\n\n");  // the escaped \n is written as is since the beginning
         }
-        return res;
+    }
+    template <size_t N>
+    static void m_writeColor(TextWriter& vWriter, const char (&vKey)[N], const Color& vColor) {
+        vWriter.write(vKey);
+        vWriter.writeFixed6(vColor[0]);
+        vWriter.write(' ');
+        vWriter.writeFixed6(vColor[1]);
+        vWriter.write(' ');
+        vWriter.writeFixed6(vColor[2]);
     }
     static uint32_t m_getFaceItemId(const int32_t& vIdx, const uint32_t& vOffset, const uint32_t& vItemCount) {
         if (vIdx < 0) {
@@ -586,64 +5025,298 @@ illum %u
         }
         return (uint32_t)(vIdx + 1U + vOffset);
     }
-    static std::string m_getObjModelString(const Model& vModel, const std::string& vMTLFile, const uint32_t& vVerticeOffset,
-                                         const uint32_t& vUvsOffset) {
-        bool have_uvs = !vModel.uvs.empty();
-        std::string res;
-        res += m_toStr("mtllib %s\no %s\n", vMTLFile.c_str(), vModel.name.c_str());
-        for (const auto& vertex : vModel.vertices) {
-            res += m_toStr("v %.6f %.6f %.6f\n", vertex[0], vertex[1], vertex[2]);
-        }
-        for (const auto& uv : vModel.uvs) {
-            res += m_toStr("vt %.6f %.6f\n", uv[0], uv[1]);
-        }
-        res += m_toStr("s %i\n", vModel.smooth_shading ? 1 : 0);
-        res += m_toStr("usemtl %s\n", vModel.mat.name.c_str());
-        auto vertices_count = (uint32_t)vModel.vertices.size();
-        auto uvs_count = (uint32_t)vModel.uvs.size();
-        for (const auto& face : vModel.faces) {
-            if (face.size() == 3U) {
-                const auto& iv0 = m_getFaceItemId(face[0], vVerticeOffset, vertices_count);
-                const auto& iv1 = m_getFaceItemId(face[1], vVerticeOffset, vertices_count);
-                const auto& iv2 = m_getFaceItemId(face[2], vVerticeOffset, vertices_count);
-                const auto& iuv0 = m_getFaceItemId(face[0], vUvsOffset, uvs_count);
-                const auto& iuv1 = m_getFaceItemId(face[1], vUvsOffset, uvs_count);
-                const auto& iuv2 = m_getFaceItemId(face[2], vUvsOffset, uvs_count);
-                if (have_uvs) {
-                    res += m_toStr("f %u/%u %u/%u %u/%u\n", iv0, iuv0, iv1, iuv1, iv2, iuv2);
-                } else {
-                    res += m_toStr("f %u %u %u\n", iv0, iv1, iv2);
-                }
-            } else if (face.size() == 4U) {
-                const auto& iv0 = m_getFaceItemId(face[0], vVerticeOffset, vertices_count);
-                const auto& iv1 = m_getFaceItemId(face[1], vVerticeOffset, vertices_count);
-                const auto& iv2 = m_getFaceItemId(face[2], vVerticeOffset, vertices_count);
-                const auto& iv3 = m_getFaceItemId(face[3], vVerticeOffset, vertices_count);
-                const auto& iuv0 = m_getFaceItemId(face[0], vUvsOffset, uvs_count);
-                const auto& iuv1 = m_getFaceItemId(face[1], vUvsOffset, uvs_count);
-                const auto& iuv2 = m_getFaceItemId(face[2], vUvsOffset, uvs_count);
-                const auto& iuv3 = m_getFaceItemId(face[3], vUvsOffset, uvs_count);
-                if (have_uvs) {
-                    res += m_toStr("f %u/%u %u/%u %u/%u %u/%u\n", iv0, iuv0, iv1, iuv1, iv2, iuv2, iv3, iuv3);
-                } else {
-                    res += m_toStr("f %u %u %u %u\n", iv0, iv1, iv2, iv3);
+    // v, v/vt, v//vn or v/vt/vn
+    static void m_writeFaceItem(TextWriter& vWriter, const uint32_t& vVertexId, const uint32_t& vUVId, const bool& vHaveUVs,
+                                const uint32_t& vNormalId, const bool& vHaveNormals) {
+        vWriter.writeUInt(vVertexId);
+        if (vHaveUVs || vHaveNormals) {
+            vWriter.write('/');
+            if (vHaveUVs) {
+                vWriter.writeUInt(vUVId);
+            }
+            if (vHaveNormals) {
+                vWriter.write('/');
+                vWriter.writeUInt(vNormalId);
+            }
+        }
+    }
+    static void m_writeObjModel(TextWriter& vWriter, const Model& vModel, const std::string& vMTLFile, const uint32_t& vVerticeOffset,
+                                const uint32_t& vUvsOffset, const uint32_t& vNormalsOffset) {
+        auto vertices_count = (uint32_t)vModel.getVerticesCount();
+        auto uvs_count = (uint32_t)vModel.getUVsCount();
+        bool have_uvs = (uvs_count != 0U);
+        bool have_normals = !vModel.normals.empty();
+        vWriter.write("mtllib ");
+        vWriter.write(vMTLFile);
+        vWriter.write("\no ");
+        vWriter.write(vModel.name);
+        vWriter.write('\n');
+        // the merged models, with their ranges of faces and of vertices (from 1, in the object)
+        for (const auto& part : vModel.parts) {
+            vWriter.write("# part ");
+            vWriter.write(part.name);
+            vWriter.write(" : faces ");
+            vWriter.writeUInt(part.first_face + 1U);
+            vWriter.write(" to ");
+            vWriter.writeUInt(part.first_face + part.faces_count);
+            vWriter.write(", vertices ");
+            vWriter.writeUInt(part.first_vertex + 1U);
+            vWriter.write(" to ");
+            vWriter.writeUInt(part.first_vertex + part.vertices_count);
+            vWriter.write('\n');
+        }
+        for (uint32_t idx = 0U; idx < vertices_count; ++idx) {
+            const auto vertex = vModel.getVertex(idx);
+            vWriter.write("v ");
+            vWriter.writeFixed6(vertex[0]);
+            vWriter.write(' ');
+            vWriter.writeFixed6(vertex[1]);
+            vWriter.write(' ');
+            vWriter.writeFixed6(vertex[2]);
+            vWriter.write('\n');
+        }
+        for (uint32_t idx = 0U; idx < uvs_count; ++idx) {
+            const auto uv = vModel.getUV(idx);
+            vWriter.write("vt ");
+            vWriter.writeFixed6(uv[0]);
+            vWriter.write(' ');
+            vWriter.writeFixed6(uv[1]);
+            vWriter.write('\n');
+        }
+        for (const auto& normal : vModel.normals) {
+            vWriter.write("vn ");
+            vWriter.writeFixed6(normal[0]);
+            vWriter.write(' ');
+            vWriter.writeFixed6(normal[1]);
+            vWriter.write(' ');
+            vWriter.writeFixed6(normal[2]);
+            vWriter.write('\n');
+        }
+        vWriter.write("s ");
+        vWriter.writeInt(vModel.smooth_shading ? 1 : 0);
+        vWriter.write("\nusemtl ");
+        vWriter.write(vModel.mat.name);
+        vWriter.write('\n');
+        const auto* face = vModel.indices.data();
+        const auto faces_count = vModel.getFacesCount();
+        for (size_t face_id = 0U; face_id < faces_count; ++face_id) {
+            const size_t face_size = vModel.face_sizes.empty() ? 3U : vModel.face_sizes[face_id];
+            vWriter.write('f');
+            for (size_t i = 0U; i < face_size; ++i) {
+                vWriter.write(' ');
+                m_writeFaceItem(vWriter,                                                //
+                                m_getFaceItemId(face[i], vVerticeOffset, vertices_count),  //
+                                m_getFaceItemId(face[i], vUvsOffset, uvs_count),           //
+                                have_uvs,                                                  //
+                                have_normals ? vModel.normal_indices[(size_t)(face - vModel.indices.data()) + i] + 1U + vNormalsOffset : 0U,
+                                have_normals);
+            }
+            vWriter.write('\n');
+            face += face_size;
+        }
+    }
+    // call vFunctor(i0, i1, i2) for each triangle of the model, with indices from 0.
+    // the faces with more than 3 vertices are cut in fans, the triangles with an index out of range are skipped
+    template <typename TFunctor>
+    static void m_forEachTriangle(const Model& vModel, const TFunctor& vFunctor) {
+        m_forEachTriangleItems(vModel, [&vFunctor](const uint32_t* vIds, const size_t*) {  //
+            vFunctor(vIds[0], vIds[1], vIds[2]);
+        });
+    }
+    // same as m_forEachTriangle, vFunctor(ids, items) receive the 3 indices and their positions in the indices of the model
+    template <typename TFunctor>
+    static void m_forEachTriangleItems(const Model& vModel, const TFunctor& vFunctor) {
+        const auto vertices_count = (int64_t)vModel.getVerticesCount();
+        size_t face_begin = 0U;
+        const auto faces_count = vModel.getFacesCount();
+        for (size_t face_id = 0U; face_id < faces_count; ++face_id) {
+            const size_t face_size = vModel.face_sizes.empty() ? 3U : vModel.face_sizes[face_id];
+            for (size_t i = 2U; i < face_size; ++i) {
+                const size_t items[3] = {face_begin, face_begin + i - 1U, face_begin + i};
+                uint32_t res[3];
+                bool valid = true;
+                for (size_t c = 0U; c < 3U; ++c) {
+                    const int64_t idx = vModel.indices[items[c]];
+                    const auto id = idx < 0 ? idx + vertices_count : idx;
+                    valid &= (id >= 0 && id < vertices_count);
+                    res[c] = (uint32_t)id;
                 }
-            } else {
-                res += "f ";
-                for (const auto& i : face) {
-                    const auto& iv = m_getFaceItemId(i, vVerticeOffset, vertices_count);
-                    const auto& iuv = m_getFaceItemId(i, vUvsOffset, uvs_count);
-                    if (have_uvs) {
-                        res += m_toStr("%u/%u ", iv, iuv);
-                    } else {
-                        res += m_toStr("%u ", iv);
-                    }
+                if (valid) {
+                    vFunctor(res, items);
                 }
-                // possible because the alst char is always a space
-                // so we replace it by a \n
-                res.back() = '\n';
             }
+            face_begin += face_size;
+        }
+    }
+    static size_t m_getGlbVertexId(const GlbMesh& vMesh, const size_t& vIdx) {
+        return vMesh.have_normals ? vMesh.vertex_ids[vIdx] : vIdx;
+    }
+    // 3 floats, or 3 uint16 padded to 4 bytes
+    static size_t m_getGlbPositionSize(const GlbMesh& vMesh) {
+        return vMesh.quantized ? 4U * sizeof(uint16_t) : 3U * sizeof(float);
+    }
+    static size_t m_getGlbIndicesSize(const GlbMesh& vMesh) {
+        return vMesh.triangles_count * 3U * (vMesh.short_indices ? sizeof(uint16_t) : sizeof(uint32_t));
+    }
+    // the glb numbers are little endian
+    static void m_writeUInt16LE(TextWriter& vWriter, const uint16_t& vValue) {
+        const char bytes[2] = {(char)(vValue & 0xFFU), (char)(vValue >> 8U)};
+        vWriter.write(bytes, 2U);
+    }
+    static void m_writeUInt32LE(TextWriter& vWriter, const uint32_t& vValue) {
+        const char bytes[4] = {(char)(vValue & 0xFFU), (char)((vValue >> 8U) & 0xFFU), (char)((vValue >> 16U) & 0xFFU), (char)(vValue >> 24U)};
+        vWriter.write(bytes, 4U);
+    }
+    static void m_writeFloat32LE(TextWriter& vWriter, const double& vValue) {
+        const float value = (float)vValue;
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        m_writeUInt32LE(vWriter, bits);
+    }
+    static std::string m_getJsonString(const std::string& vStr) {
+        std::string res = "\"";
+        for (const auto& c : vStr) {
+            if (c == '"' || c == '\\') {
+                res += '\\';
+                res += c;
+            } else if ((unsigned char)c < 0x20U) {
+                char buffer[8];
+                snprintf(buffer, sizeof(buffer), "\\u%04x", (unsigned)c);
+                res += buffer;
+            } else {
+                res += c;
+            }
+        }
+        return res + "\"";
+    }
+    // shortest text who give back the same float, with a '.' whatever the locale
+    static std::string m_getJsonNumber(const double& vValue) {
+        char buffer[32];
+        const int len = snprintf(buffer, sizeof(buffer), "%.9g", vValue);
+        std::string res(buffer, (size_t)std::max(len, 0));
+        const char locale_point = *localeconv()->decimal_point;
+        if (locale_point != '.') {
+            std::replace(res.begin(), res.end(), locale_point, '.');
         }
         return res;
     }
+    std::string m_getGlbJson(const std::vector<Model>& vModels, const std::vector<GlbMesh>& vMeshes, const size_t& vBinSize) const {
+        std::string nodes, meshes, materials, accessors, views, images, textures;
+        std::map<std::string, size_t> images_ids;
+        std::map<std::string, size_t> materials_ids;  // by json, the merged materials are shared by several meshes
+        size_t accessors_count = 0U;
+        size_t views_count = 0U;
+        bool quantized = false;
+        auto add_view = [&](const size_t& vOffset, const size_t& vSize, const uint32_t& vTarget, const size_t& vStride) {
+            views += std::string(views_count ? "," : "") + "{\"buffer\":0,\"byteOffset\":" + std::to_string(vOffset) +
+                     ",\"byteLength\":" + std::to_string(vSize) + (vStride ? ",\"byteStride\":" + std::to_string(vStride) : "") +
+                     ",\"target\":" + std::to_string(vTarget) + "}";
+            return views_count++;
+        };
+        auto add_accessor = [&](const size_t& vView, const uint32_t& vComponentType, const size_t& vCount, const char* vType,
+                                const std::string& vMinMax) {
+            accessors += std::string(accessors_count ? "," : "") + "{\"bufferView\":" + std::to_string(vView) +
+                         ",\"componentType\":" + std::to_string(vComponentType) + ",\"count\":" + std::to_string(vCount) +
+                         ",\"type\":\"" + vType + "\"" + vMinMax + "}";
+            return accessors_count++;
+        };
+        for (size_t idx = 0U; idx < vMeshes.size(); ++idx) {
+            const auto& mesh = vMeshes[idx];
+            const auto& model = vModels[mesh.model_idx];
+            const auto& mat = model.mat;
+            const std::string sep = idx ? "," : "";
+
+            // accessors
+            std::string min_max = ",\"min\":[";
+            for (size_t c = 0U; c < 3U; ++c) {
+                min_max += (c ? "," : "") + m_getJsonNumber(mesh.min[c]);
+            }
+            min_max += "],\"max\":[";
+            for (size_t c = 0U; c < 3U; ++c) {
+                min_max += (c ? "," : "") + m_getJsonNumber(mesh.max[c]);
+            }
+            min_max += "]";
+            const auto vertices_count = mesh.vertices_count;
+            const auto position_size = m_getGlbPositionSize(mesh);
+            const auto positions = add_accessor(add_view(mesh.positions_offset, vertices_count * position_size, 34962U,  // ARRAY_BUFFER
+                                                         mesh.quantized ? position_size : 0U),
+                                                mesh.quantized ? 5123U : 5126U, vertices_count, "VEC3", min_max);  // UNSIGNED_SHORT / FLOAT
+            std::string attributes = "\"POSITION\":" + std::to_string(positions);
+            if (mesh.have_uvs) {
+                const auto uvs = add_accessor(add_view(mesh.uvs_offset, vertices_count * 8U, 34962U, 0U), 5126U, vertices_count, "VEC2", "");
+                attributes += ",\"TEXCOORD_0\":" + std::to_string(uvs);
+            }
+            if (mesh.have_normals) {
+                const auto normals = add_accessor(add_view(mesh.normals_offset, vertices_count * 12U, 34962U, 0U), 5126U, vertices_count, "VEC3", "");
+                attributes += ",\"NORMAL\":" + std::to_string(normals);
+            }
+            const auto indices = add_accessor(add_view(mesh.indices_offset, m_getGlbIndicesSize(mesh), 34963U, 0U),  // ELEMENT_ARRAY_BUFFER
+                                              mesh.short_indices ? 5123U : 5125U,                               // UNSIGNED_SHORT / UNSIGNED_INT
+                                              mesh.triangles_count * 3U, "SCALAR", "");
+
+            // material, the mdl phong parameters are approximated with a dielectric pbr material
+            const double roughness = std::sqrt(2.0 / (std::max(mat.Ns, 0.0) + 2.0));
+            std::string pbr = "\"baseColorFactor\":[" + m_getJsonNumber(mat.Ka[0]) + "," + m_getJsonNumber(mat.Ka[1]) + "," +
+                              m_getJsonNumber(mat.Ka[2]) + "," + m_getJsonNumber(mat.d) + "],\"metallicFactor\":0,\"roughnessFactor\":" +
+                              m_getJsonNumber(roughness);
+            const auto texture_end = mat.ka_texture.find_last_not_of(' ');
+            if (texture_end != std::string::npos && mesh.have_uvs) {
+                const auto texture = mat.ka_texture.substr(0U, texture_end + 1U);
+                auto it = images_ids.find(texture);
+                if (it == images_ids.end()) {
+                    const auto id = images_ids.size();
+                    images += std::string(id ? "," : "") + "{\"uri\":" + m_getJsonString(texture) + "}";
+                    textures += std::string(id ? "," : "") + "{\"sampler\":0,\"source\":" + std::to_string(id) + "}";
+                    it = images_ids.emplace(texture, id).first;
+                }
+                pbr += ",\"baseColorTexture\":{\"index\":" + std::to_string(it->second) + "}";
+            }
+            const auto material_json = "{\"name\":" + m_getJsonString(mat.name) + ",\"pbrMetallicRoughness\":{" + pbr + "}" +
+                                       (mat.d < 1.0 ? ",\"alphaMode\":\"BLEND\"" : "") + "}";
+            auto material = materials_ids.find(material_json);
+            if (material == materials_ids.end()) {
+                const auto id = materials_ids.size();
+                materials += (id ? "," : "") + material_json;
+                material = materials_ids.emplace(material_json, id).first;
+            }
+
+            // the names of the merged models
+            std::string extras;
+            for (size_t part = 0U; part < model.parts.size(); ++part) {
+                extras += (part ? "," : ",\"extras\":{\"parts\":[") + m_getJsonString(model.parts[part].name);
+            }
+            if (!extras.empty()) {
+                extras += "]}";
+            }
+            meshes += sep + "{\"name\":" + m_getJsonString(model.name) + ",\"primitives\":[{\"attributes\":{" + attributes +
+                      "},\"indices\":" + std::to_string(indices) + ",\"material\":" + std::to_string(material->second) + ",\"mode\":4}]" +
+                      extras + "}";
+            std::string transform;
+            if (mesh.quantized) {
+                quantized = true;
+                transform = ",\"translation\":[" + m_getJsonNumber(model.vertices_min[0]) + "," + m_getJsonNumber(model.vertices_min[1]) + "," +
+                            m_getJsonNumber(model.vertices_min[2]) + "],\"scale\":[" + m_getJsonNumber(model.vertices_step[0]) + "," +
+                            m_getJsonNumber(model.vertices_step[1]) + "," + m_getJsonNumber(model.vertices_step[2]) + "]";
+            }
+            nodes += sep + "{\"name\":" + m_getJsonString(model.name) + ",\"mesh\":" + std::to_string(idx) + transform + "}";
+        }
+        std::string scene_nodes;
+        for (size_t idx = 0U; idx < vMeshes.size(); ++idx) {
+            scene_nodes += (idx ? "," : "") + std::to_string(idx);
+        }
+        std::string json = "{\"asset\":{\"version\":\"2.0\",\"generator\":\"MdlToObj " MDL_TO_OBJ_VERSION "\"}";
+        if (quantized) {
+            json += ",\"extensionsUsed\":[\"KHR_mesh_quantization\"],\"extensionsRequired\":[\"KHR_mesh_quantization\"]";
+        }
+        json += ",\"scene\":0,\"scenes\":[{\"nodes\":[" + scene_nodes + "]}]";
+        if (!vMeshes.empty()) {
+            json += ",\"nodes\":[" + nodes + "],\"meshes\":[" + meshes + "],\"materials\":[" + materials + "]";
+            json += ",\"accessors\":[" + accessors + "],\"bufferViews\":[" + views + "]";
+            json += ",\"buffers\":[{\"byteLength\":" + std::to_string(vBinSize) + "}]";
+        }
+        if (!images.empty()) {
+            json += ",\"samplers\":[{}],\"images\":[" + images + "],\"textures\":[" + textures + "]";
+        }
+        return json + "}";
+    }
 };
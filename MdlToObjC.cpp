@@ -0,0 +1,195 @@
+/*
+MIT License
+
+Copyright (c) 2023 Stephane Cuillerdier (aka Aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "MdlToObjC.h"
+#include "MdlToObj.hpp"
+
+struct MdlToObjConverter {
+    MdlToObj converter;
+};
+
+// the exceptions (bad_alloc..) must not cross the c interface
+template <typename TFunctor>
+static int callSafely(const TFunctor& vFunctor) {
+    try {
+        return vFunctor() ? 1 : 0;
+    } catch (...) {
+        return 0;
+    }
+}
+
+static std::string getMtlFileName(const char* vMtlFileName) {
+    return (vMtlFileName != nullptr) ? vMtlFileName : "model.mtl";
+}
+
+static char* copyText(const std::string& vText) {
+    auto* res = static_cast<char*>(std::malloc(vText.size() + 1U));
+    if (res != nullptr) {
+        memcpy(res, vText.data(), vText.size());
+        res[vText.size()] = '\0';
+    }
+    return res;
+}
+
+const char* mdl_to_obj_get_version(void) {
+    return MDL_TO_OBJ_VERSION;
+}
+
+MdlToObjConverter* mdl_to_obj_create(void) {
+    try {
+        return new MdlToObjConverter();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void mdl_to_obj_destroy(MdlToObjConverter* vConverter) {
+    delete vConverter;
+}
+
+void mdl_to_obj_reset(MdlToObjConverter* vConverter) {
+    if (vConverter != nullptr) {
+        callSafely([&]() {
+            vConverter->converter.reset();
+            return true;
+        });
+    }
+}
+
+void mdl_to_obj_set_threads_count(MdlToObjConverter* vConverter, uint32_t vThreadsCount) {
+    if (vConverter != nullptr) {
+        vConverter->converter.setThreadsCount(vThreadsCount);
+    }
+}
+
+void mdl_to_obj_set_precision(MdlToObjConverter* vConverter, int vPrecision) {
+    if (vConverter != nullptr && vPrecision >= MDL_TO_OBJ_PRECISION_DOUBLE && vPrecision <= MDL_TO_OBJ_PRECISION_Q16) {
+        vConverter->converter.setPrecision(static_cast<Precision>(vPrecision));
+    }
+}
+
+void mdl_to_obj_set_normals(MdlToObjConverter* vConverter, int vEnabled, double vCreaseAngle) {
+    if (vConverter != nullptr) {
+        vConverter->converter.setComputeNormals(vEnabled != 0);
+        vConverter->converter.setCreaseAngle(vCreaseAngle);
+    }
+}
+
+void mdl_to_obj_set_merge(MdlToObjConverter* vConverter, int vEnabled) {
+    if (vConverter != nullptr) {
+        vConverter->converter.setMergeModels(vEnabled != 0);
+    }
+}
+
+void mdl_to_obj_set_component_filter(MdlToObjConverter* vConverter, const char* const* vPatterns, size_t vCount) {
+    if (vConverter != nullptr && (vPatterns != nullptr || !vCount)) {
+        callSafely([&]() {
+            std::vector<std::string> patterns;
+            for (size_t idx = 0U; idx < vCount; ++idx) {
+                if (vPatterns[idx] != nullptr) {
+                    patterns.push_back(vPatterns[idx]);
+                }
+            }
+            vConverter->converter.setComponentFilter(patterns);
+            return true;
+        });
+    }
+}
+
+int mdl_to_obj_open_buffer(MdlToObjConverter* vConverter, const char* vData, size_t vSize, const char* vName) {
+    if (vConverter == nullptr || (vData == nullptr && vSize)) {
+        return 0;
+    }
+    return callSafely([&]() {  //
+        return vConverter->converter.openMdlBuffer(vData, vSize, (vName != nullptr) ? vName : "memory.mdl");
+    });
+}
+
+int mdl_to_obj_open_reader(MdlToObjConverter* vConverter, MdlToObjReadFunc vReader, void* vUserData, const char* vName) {
+    if (vConverter == nullptr || vReader == nullptr) {
+        return 0;
+    }
+    return callSafely([&]() {
+        return vConverter->converter.openMdlReader([&](char* vBuffer, size_t vSize) { return vReader(vUserData, vBuffer, vSize); },
+                                                   (vName != nullptr) ? vName : "memory.mdl");
+    });
+}
+
+int mdl_to_obj_save_to_callbacks(MdlToObjConverter* vConverter, MdlToObjWriteFunc vObjWriter, void* vObjUserData, MdlToObjWriteFunc vMtlWriter,
+                                 void* vMtlUserData, const char* vMtlFileName) {
+    if (vConverter == nullptr || vObjWriter == nullptr || vMtlWriter == nullptr) {
+        return 0;
+    }
+    return callSafely([&]() {
+        CallbackSink obj_sink([&](const char* vData, size_t vSize) { return vObjWriter(vObjUserData, vData, vSize) != 0; });
+        CallbackSink mtl_sink([&](const char* vData, size_t vSize) { return vMtlWriter(vMtlUserData, vData, vSize) != 0; });
+        return vConverter->converter.saveObjToSinks(obj_sink, mtl_sink, getMtlFileName(vMtlFileName));
+    });
+}
+
+int mdl_to_obj_save_to_fds(MdlToObjConverter* vConverter, int vObjFd, int vMtlFd, const char* vMtlFileName) {
+    if (vConverter == nullptr) {
+        return 0;
+    }
+    return callSafely([&]() {
+        FdSink obj_sink(vObjFd);
+        FdSink mtl_sink(vMtlFd);
+        return vConverter->converter.saveObjToSinks(obj_sink, mtl_sink, getMtlFileName(vMtlFileName));
+    });
+}
+
+int mdl_to_obj_save_to_buffers(MdlToObjConverter* vConverter, char** vOutObj, size_t* vOutObjSize, char** vOutMtl, size_t* vOutMtlSize,
+                               const char* vMtlFileName) {
+    if (vConverter == nullptr || vOutObj == nullptr || vOutObjSize == nullptr || vOutMtl == nullptr || vOutMtlSize == nullptr) {
+        return 0;
+    }
+    *vOutObj = nullptr;
+    *vOutMtl = nullptr;
+    *vOutObjSize = 0U;
+    *vOutMtlSize = 0U;
+    return callSafely([&]() {
+        BufferSink obj_sink;
+        BufferSink mtl_sink;
+        if (!vConverter->converter.saveObjToSinks(obj_sink, mtl_sink, getMtlFileName(vMtlFileName))) {
+            return false;
+        }
+        // the texts are null terminated, for the callers who use them as strings
+        *vOutObj = copyText(obj_sink.getData());
+        *vOutMtl = copyText(mtl_sink.getData());
+        if (*vOutObj == nullptr || *vOutMtl == nullptr) {
+            std::free(*vOutObj);
+            std::free(*vOutMtl);
+            *vOutObj = nullptr;
+            *vOutMtl = nullptr;
+            return false;
+        }
+        *vOutObjSize = obj_sink.getData().size();
+        *vOutMtlSize = mtl_sink.getData().size();
+        return true;
+    });
+}
+
+void mdl_to_obj_free(void* vPtr) {
+    std::free(vPtr);
+}
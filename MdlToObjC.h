@@ -0,0 +1,93 @@
+/*
+MIT License
+
+Copyright (c) 2023 Stephane Cuillerdier (aka Aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// C interface of MdlToObj, for load the converter in process from other languages (python ctypes, go cgo..).
+// a converter parse one or more mdl sources from memory, then give the obj and mtl texts to callbacks,
+// buffers or file descriptors, without temporary files.
+// the functions returning an int return 1 on success and 0 on failure, they never throw
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#if defined(MDL_TO_OBJ_C_BUILD)
+#define MDL_TO_OBJ_C_API __declspec(dllexport)
+#else
+#define MDL_TO_OBJ_C_API __declspec(dllimport)
+#endif
+#else
+#define MDL_TO_OBJ_C_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct MdlToObjConverter MdlToObjConverter;
+
+// fill vBuffer with at most vSize bytes of the source, return the count of bytes given, 0 at the end
+typedef size_t (*MdlToObjReadFunc)(void* vUserData, char* vBuffer, size_t vSize);
+// receive a part of the saved text, return 0 for stop the writing
+typedef int (*MdlToObjWriteFunc)(void* vUserData, const char* vData, size_t vSize);
+
+// storage of the vertices and uvs, see MdlToObj::setPrecision
+enum { MDL_TO_OBJ_PRECISION_DOUBLE = 0, MDL_TO_OBJ_PRECISION_FLOAT = 1, MDL_TO_OBJ_PRECISION_Q16 = 2 };
+
+MDL_TO_OBJ_C_API const char* mdl_to_obj_get_version(void);
+
+MDL_TO_OBJ_C_API MdlToObjConverter* mdl_to_obj_create(void);
+MDL_TO_OBJ_C_API void mdl_to_obj_destroy(MdlToObjConverter* vConverter);
+// forget the opened files for convert another one with the same options, the storage of the models is reused
+MDL_TO_OBJ_C_API void mdl_to_obj_reset(MdlToObjConverter* vConverter);
+
+// 0 for the count of cores
+MDL_TO_OBJ_C_API void mdl_to_obj_set_threads_count(MdlToObjConverter* vConverter, uint32_t vThreadsCount);
+MDL_TO_OBJ_C_API void mdl_to_obj_set_precision(MdlToObjConverter* vConverter, int vPrecision);
+// vEnabled != 0 for save the normals, see MdlToObj::setComputeNormals and MdlToObj::setCreaseAngle
+MDL_TO_OBJ_C_API void mdl_to_obj_set_normals(MdlToObjConverter* vConverter, int vEnabled, double vCreaseAngle);
+// vEnabled != 0 for merge the models with the same material and shading, see MdlToObj::setMergeModels
+MDL_TO_OBJ_C_API void mdl_to_obj_set_merge(MdlToObjConverter* vConverter, int vEnabled);
+// only the components matching one of the vCount patterns (* and ? wildcards) are parsed and saved, 0 pattern for all.
+// see MdlToObj::setComponentFilter
+MDL_TO_OBJ_C_API void mdl_to_obj_set_component_filter(MdlToObjConverter* vConverter, const char* const* vPatterns, size_t vCount);
+
+// vData is a mdl text, or a zip file containing a mdl file. vName is used in the logs, it can be NULL
+MDL_TO_OBJ_C_API int mdl_to_obj_open_buffer(MdlToObjConverter* vConverter, const char* vData, size_t vSize, const char* vName);
+MDL_TO_OBJ_C_API int mdl_to_obj_open_reader(MdlToObjConverter* vConverter, MdlToObjReadFunc vReader, void* vUserData, const char* vName);
+
+// the obj text reference the mtl file vMtlFileName
+MDL_TO_OBJ_C_API int mdl_to_obj_save_to_callbacks(MdlToObjConverter* vConverter, MdlToObjWriteFunc vObjWriter, void* vObjUserData,
+                                                  MdlToObjWriteFunc vMtlWriter, void* vMtlUserData, const char* vMtlFileName);
+// the file descriptors are not closed
+MDL_TO_OBJ_C_API int mdl_to_obj_save_to_fds(MdlToObjConverter* vConverter, int vObjFd, int vMtlFd, const char* vMtlFileName);
+// the texts are allocated by the library, and must be released with mdl_to_obj_free
+MDL_TO_OBJ_C_API int mdl_to_obj_save_to_buffers(MdlToObjConverter* vConverter, char** vOutObj, size_t* vOutObjSize, char** vOutMtl,
+                                                size_t* vOutMtlSize, const char* vMtlFileName);
+MDL_TO_OBJ_C_API void mdl_to_obj_free(void* vPtr);
+
+#ifdef __cplusplus
+}
+#endif
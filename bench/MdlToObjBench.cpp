@@ -0,0 +1,361 @@
+/*
+MIT License
+
+Copyright (c) 2023 Stephane Cuillerdier (aka Aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// benchmark of openMdlFile and saveObjFile, on the samples and on synthetic mdl files.
+// the results are written in a json file
+
+#include <chrono>
+#include <locale>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include "../MdlToObj.hpp"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#ifndef MDL_TO_OBJ_BENCH_SAMPLES_DIR
+#define MDL_TO_OBJ_BENCH_SAMPLES_DIR "samples"
+#endif
+
+struct BenchInput {
+    std::string name;
+    std::string file;
+    std::string kind;   // sample or synthetic
+    std::string polys;  // strip or fan, for the synthetic files
+    bool uvs = false;
+};
+
+struct BenchResult {
+    BenchInput input;
+    uint32_t threads = 0U;
+    uint64_t source_bytes = 0U;
+    uint64_t obj_bytes = 0U;
+    size_t vertices = 0U;
+    size_t faces = 0U;
+    double parse_seconds = 0.0;  // best of the repeats
+    double save_seconds = 0.0;
+};
+
+static uint64_t getFileSize(const std::string& vFile) {
+    uint64_t size = 0U;
+    if (auto file = std::fopen(vFile.c_str(), "rb")) {
+        if (std::fseek(file, 0, SEEK_END) == 0) {
+            const auto pos = std::ftell(file);
+            size = (pos > 0) ? (uint64_t)pos : 0U;
+        }
+        std::fclose(file);
+    }
+    return size;
+}
+
+// the mdl files of vDir, sorted by name
+static std::vector<std::string> getMdlFiles(const std::string& vDir) {
+    std::vector<std::string> files;
+#ifdef _WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE handle = FindFirstFileA((vDir + "\\*.mdl").c_str(), &data);
+    if (handle != INVALID_HANDLE_VALUE) {
+        do {
+            files.push_back(vDir + "/" + data.cFileName);
+        } while (FindNextFileA(handle, &data));
+        FindClose(handle);
+    }
+#else
+    DIR* dir = opendir(vDir.c_str());
+    if (dir != nullptr) {
+        while (auto entry = readdir(dir)) {
+            const std::string name = entry->d_name;
+            if (name.size() > 4U && name.substr(name.size() - 4U) == ".mdl") {
+                files.push_back(vDir + "/" + name);
+            }
+        }
+        closedir(dir);
+    }
+#endif
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+// a grid of vVerticesCount vertices, cut in meshes of at most 256K vertices.
+// the polys are triangle strips along the rows, or quads (4 indices triangle fans)
+static bool generateMdlFile(const std::string& vFile, const size_t& vVerticesCount, const bool& vUVs, const bool& vStrips) {
+    auto file = std::fopen(vFile.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    static const size_t columns = 128U;
+    static const size_t max_rows = 2048U;
+    std::fprintf(file, "# synthetic mdl file generated by MdlToObjBench\n");
+    size_t rows_remaining = std::max<size_t>((vVerticesCount + columns - 1U) / columns, 2U);
+    for (size_t mesh_id = 0U; rows_remaining > 0U; ++mesh_id) {
+        const size_t rows = std::max<size_t>(std::min(rows_remaining, max_rows), 2U);
+        rows_remaining -= std::min(rows_remaining, rows);
+        std::fprintf(file, "Component Synth_%zu\n\tPolygonMesh\n", mesh_id);
+        std::fprintf(file, "\t\tFaceColor %%200180160\n\t\tSmoothShading Yes\n\t\tTranslucency 0.000000\n");
+        std::fprintf(file, "\t\tSpecularity 0.200000\n\t\tShininess 76\n\t\tNumVerts %zu\n", rows * columns);
+        std::fprintf(file, vUVs ? "\t\tDataTx\n" : "\t\tData\n");
+        for (size_t row = 0U; row < rows; ++row) {
+            for (size_t col = 0U; col < columns; ++col) {
+                const double x = (double)col * 0.01;
+                const double y = (double)(mesh_id * max_rows + row) * 0.01;
+                const double z = 0.25 * std::sin(x * 3.0) * std::cos(y * 2.0);
+                if (vUVs) {
+                    std::fprintf(file, "\t\t\t%.11f %.11f %.11f %.6f %.6f\n", x, y, z,  //
+                                 (double)col / (double)(columns - 1U), (double)row / (double)(rows - 1U));
+                } else {
+                    std::fprintf(file, "\t\t\t%.11f %.11f %.11f\n", x, y, z);
+                }
+            }
+        }
+        if (vStrips) {
+            std::fprintf(file, "\t\tNumPolys %zu\n\t\tPolys\n", rows - 1U);
+            for (size_t row = 0U; row + 1U < rows; ++row) {
+                std::fprintf(file, "\t\t\t-1 %zu", columns * 2U);
+                for (size_t col = 0U; col < columns; ++col) {
+                    std::fprintf(file, " %zu %zu", row * columns + col, (row + 1U) * columns + col);
+                }
+                std::fprintf(file, "\n");
+            }
+        } else {
+            std::fprintf(file, "\t\tNumPolys %zu\n\t\tPolys\n", (rows - 1U) * (columns - 1U));
+            for (size_t row = 0U; row + 1U < rows; ++row) {
+                for (size_t col = 0U; col + 1U < columns; ++col) {
+                    const size_t idx = row * columns + col;
+                    std::fprintf(file, "\t\t\t4 %zu %zu %zu %zu\n", idx, idx + 1U, idx + columns + 1U, idx + columns);
+                }
+            }
+        }
+        std::fprintf(file, "\tEndPolygonMesh\nEndComponent\n");
+    }
+    return (std::fclose(file) == 0);
+}
+
+static double getSeconds(const std::chrono::steady_clock::time_point& vStart) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - vStart).count();
+}
+
+static bool runBench(const BenchInput& vInput, const std::string& vObjFile, const uint32_t& vThreads, const uint32_t& vRepeat,
+                     BenchResult& vOutResult) {
+    vOutResult = BenchResult();
+    vOutResult.input = vInput;
+    vOutResult.threads = vThreads;
+    vOutResult.source_bytes = getFileSize(vInput.file);
+    bool res = true;
+    for (uint32_t run = 0U; run < vRepeat && res; ++run) {
+        MdlToObj converter;
+        converter.setThreadsCount(vThreads);
+        converter.setLogLevel(MdlToObj::LogLevel::None);
+        auto start = std::chrono::steady_clock::now();
+        res &= converter.openMdlFile(vInput.file);
+        const auto parse_seconds = getSeconds(start);
+        start = std::chrono::steady_clock::now();
+        res &= converter.saveObjFile(vObjFile);
+        const auto save_seconds = getSeconds(start);
+        if (!run || parse_seconds < vOutResult.parse_seconds) {
+            vOutResult.parse_seconds = parse_seconds;
+        }
+        if (!run || save_seconds < vOutResult.save_seconds) {
+            vOutResult.save_seconds = save_seconds;
+        }
+        if (!run) {
+            for (const auto& model : converter.getModels()) {
+                vOutResult.vertices += model.getVerticesCount();
+                vOutResult.faces += model.getFacesCount();
+            }
+            vOutResult.obj_bytes = getFileSize(vObjFile);
+        }
+    }
+    std::remove(vObjFile.c_str());
+    std::remove((vObjFile.substr(0U, vObjFile.size() - 4U) + ".mtl").c_str());
+    return res;
+}
+
+static std::string getJsonString(const std::string& vStr) {
+    std::string res = "\"";
+    for (const auto& c : vStr) {
+        if (c == '"' || c == '\\') {
+            res += '\\';
+        }
+        res += c;
+    }
+    return res + "\"";
+}
+
+static std::string getResultJson(const BenchResult& vResult) {
+    const double mb = 1024.0 * 1024.0;
+    const double parse_seconds = std::max(vResult.parse_seconds, 1e-9);
+    const double save_seconds = std::max(vResult.save_seconds, 1e-9);
+    std::ostringstream json;
+    json.imbue(std::locale::classic());
+    json << "    {\"name\": " << getJsonString(vResult.input.name) << ", \"kind\": " << getJsonString(vResult.input.kind);
+    if (vResult.input.kind == "synthetic") {
+        json << ", \"uvs\": " << (vResult.input.uvs ? "true" : "false") << ", \"polys\": " << getJsonString(vResult.input.polys);
+    }
+    json << ", \"threads\": " << vResult.threads << ", \"source_bytes\": " << vResult.source_bytes << ", \"obj_bytes\": " << vResult.obj_bytes
+         << ", \"vertices\": " << vResult.vertices << ", \"faces\": " << vResult.faces << ", \"parse_seconds\": " << vResult.parse_seconds
+         << ", \"save_seconds\": " << vResult.save_seconds << ", \"parse_mb_per_second\": " << vResult.source_bytes / mb / parse_seconds
+         << ", \"parse_vertices_per_second\": " << vResult.vertices / parse_seconds
+         << ", \"save_mb_per_second\": " << vResult.obj_bytes / mb / save_seconds
+         << ", \"save_vertices_per_second\": " << vResult.vertices / save_seconds << "}";
+    return json.str();
+}
+
+static std::vector<size_t> getSizes(const char* vList) {
+    std::vector<size_t> sizes;
+    char* end = nullptr;
+    for (auto value = std::strtoull(vList, &end, 10); end != vList; value = std::strtoull(vList, &end, 10)) {
+        sizes.push_back((size_t)value);
+        vList = (*end == ',') ? end + 1 : end;
+    }
+    return sizes;
+}
+
+static void printSyntax() {
+    std::cout << "MdlToObjBench Syntax : MdlToObjBench [options]" << std::endl;
+    std::cout << "  --samples dir   directory of the unzipped samples (default : " MDL_TO_OBJ_BENCH_SAMPLES_DIR ")" << std::endl;
+    std::cout << "  --sizes list    vertices counts of the synthetic files (default : 10000,100000,1000000), up to 100000000" << std::endl;
+    std::cout << "  --threads list  threads counts, for the scaling (default : 1 and the count of cores)" << std::endl;
+    std::cout << "  --repeat count  runs by file, the best time is kept (default : 3)" << std::endl;
+    std::cout << "  --tmp dir       directory of the generated files (default : current directory)" << std::endl;
+    std::cout << "  --out file      json results (default : bench_results.json)" << std::endl;
+    std::cout << "  --no-samples    only the synthetic files" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::string samples_dir = MDL_TO_OBJ_BENCH_SAMPLES_DIR;
+    std::string tmp_dir = ".";
+    std::string out_file = "bench_results.json";
+    std::vector<size_t> sizes = {10000U, 100000U, 1000000U};
+    std::vector<size_t> threads = {1U, std::max(std::thread::hardware_concurrency(), 1U)};
+    uint32_t repeat = 3U;
+    bool use_samples = true;
+    for (int idx = 1; idx < argc; ++idx) {
+        const std::string arg = argv[idx];
+        if (arg == "--samples" && idx + 1 < argc) {
+            samples_dir = argv[++idx];
+        } else if (arg == "--sizes" && idx + 1 < argc) {
+            sizes = getSizes(argv[++idx]);
+        } else if (arg == "--threads" && idx + 1 < argc) {
+            threads = getSizes(argv[++idx]);
+        } else if (arg == "--repeat" && idx + 1 < argc) {
+            repeat = std::max((uint32_t)std::strtoul(argv[++idx], nullptr, 10), 1U);
+        } else if (arg == "--tmp" && idx + 1 < argc) {
+            tmp_dir = argv[++idx];
+        } else if (arg == "--out" && idx + 1 < argc) {
+            out_file = argv[++idx];
+        } else if (arg == "--no-samples") {
+            use_samples = false;
+        } else {
+            printSyntax();
+            return (arg == "-h" || arg == "--help") ? 0 : 1;
+        }
+    }
+    std::sort(threads.begin(), threads.end());
+    threads.erase(std::unique(threads.begin(), threads.end()), threads.end());
+
+    std::vector<BenchInput> inputs;
+    if (use_samples) {
+        for (const auto& file : getMdlFiles(samples_dir)) {
+            BenchInput input;
+            input.file = file;
+            input.name = file.substr(file.find_last_of("/\\") + 1U);
+            input.kind = "sample";
+            inputs.push_back(input);
+        }
+        if (inputs.empty()) {
+            std::cout << "No mdl files in " << samples_dir << std::endl;
+        }
+    }
+    std::vector<std::string> generated_files;
+    for (const auto& size : sizes) {
+        for (int variant = 0; variant < 4; ++variant) {
+            BenchInput input;
+            input.uvs = (variant & 1) != 0;
+            input.polys = (variant & 2) ? "fan" : "strip";
+            input.name = "synth_" + std::to_string(size) + (input.uvs ? "_uvs_" : "_") + input.polys;
+            input.file = tmp_dir + "/" + input.name + ".mdl";
+            input.kind = "synthetic";
+            std::cout << "Generate " << input.file << std::endl;
+            if (!generateMdlFile(input.file, size, input.uvs, input.polys == "strip")) {
+                std::cout << "Fail to generate " << input.file << std::endl;
+                return 1;
+            }
+            generated_files.push_back(input.file);
+            inputs.push_back(input);
+        }
+    }
+
+    bool res = true;
+    std::vector<BenchResult> results;
+    std::printf("%-40s %7s %12s %10s %10s %10s %14s\n", "file", "threads", "vertices", "parse (s)", "save (s)", "parse MB/s", "parse verts/s");
+    for (const auto& input : inputs) {
+        for (const auto& count : threads) {
+            BenchResult result;
+            if (!runBench(input, tmp_dir + "/" + input.name + "_bench.obj", (uint32_t)count, repeat, result)) {
+                std::cout << "Fail to convert " << input.file << std::endl;
+                res = false;
+            }
+            std::printf("%-40s %7u %12zu %10.4f %10.4f %10.1f %14.0f\n", input.name.c_str(), result.threads, result.vertices, result.parse_seconds,
+                        result.save_seconds, result.source_bytes / (1024.0 * 1024.0) / std::max(result.parse_seconds, 1e-9),
+                        result.vertices / std::max(result.parse_seconds, 1e-9));
+            std::fflush(stdout);
+            results.push_back(result);
+        }
+    }
+    for (const auto& file : generated_files) {
+        std::remove(file.c_str());
+    }
+
+    std::ostringstream json;
+    json << "{\n  \"version\": \"" MDL_TO_OBJ_VERSION "\",\n  \"hardware_threads\": " << std::thread::hardware_concurrency()
+         << ",\n  \"repeat\": " << repeat << ",\n  \"results\": [\n";
+    for (size_t idx = 0U; idx < results.size(); ++idx) {
+        json << getResultJson(results[idx]) << (idx + 1U < results.size() ? ",\n" : "\n");
+    }
+    json << "  ]\n}\n";
+    const auto text = json.str();
+    auto file = std::fopen(out_file.c_str(), "wb");
+    if (file != nullptr && std::fwrite(text.data(), 1U, text.size(), file) == text.size() && std::fclose(file) == 0) {
+        std::cout << "Results saved in " << out_file << std::endl;
+    } else {
+        if (file != nullptr) {
+            std::fclose(file);
+        }
+        std::cout << "Fail to save the file " << out_file << std::endl;
+        res = false;
+    }
+    return res ? 0 : 1;
+}
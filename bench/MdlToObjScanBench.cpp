@@ -0,0 +1,271 @@
+/*
+MIT License
+
+Copyright (c) 2023 Stephane Cuillerdier (aka Aiekick)
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// micro benchmark of the scan kernels (line endings and tokens) on the samples.
+// with --verify, the lines and tokens of each kernel are compared with the scalar kernel
+// and with a byte by byte split, on the samples and on random texts
+
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+#include "../MdlToObj.hpp"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+#ifndef MDL_TO_OBJ_BENCH_SAMPLES_DIR
+#define MDL_TO_OBJ_BENCH_SAMPLES_DIR "samples"
+#endif
+
+struct ScanInput {
+    std::string name;
+    std::string text;
+};
+
+struct ScanResult {
+    std::vector<size_t> line_ends;
+    std::vector<size_t> tokens;
+};
+
+static const char* getLevelName(const ScanLevel& vLevel) {
+    switch (vLevel) {
+        case ScanLevel::Scalar: return "scalar";
+        case ScanLevel::SSE2: return "sse2";
+        case ScanLevel::AVX2: return "avx2";
+    }
+    return "";
+}
+
+// the mdl files of vDir, sorted by name
+static std::vector<std::string> getMdlFiles(const std::string& vDir) {
+    std::vector<std::string> files;
+#ifdef _WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE handle = FindFirstFileA((vDir + "\\*.mdl").c_str(), &data);
+    if (handle != INVALID_HANDLE_VALUE) {
+        do {
+            files.push_back(vDir + "/" + data.cFileName);
+        } while (FindNextFileA(handle, &data));
+        FindClose(handle);
+    }
+#else
+    DIR* dir = opendir(vDir.c_str());
+    if (dir != nullptr) {
+        while (auto entry = readdir(dir)) {
+            const std::string name = entry->d_name;
+            if (name.size() > 4U && name.substr(name.size() - 4U) == ".mdl") {
+                files.push_back(vDir + "/" + name);
+            }
+        }
+        closedir(dir);
+    }
+#endif
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+static bool readFile(const std::string& vFile, std::string& vOutText) {
+    auto file = std::fopen(vFile.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    vOutText.clear();
+    char buffer[65536];
+    size_t size = 0U;
+    while ((size = std::fread(buffer, 1U, sizeof(buffer), file)) > 0U) {
+        vOutText.append(buffer, size);
+    }
+    std::fclose(file);
+    return true;
+}
+
+// texts made of the chars who matter for the scan, for test the tokens and lines across the 64 bytes blocks
+static std::vector<ScanInput> getRandomInputs() {
+    static const char chars[] = {' ', '\t', '\r', '\n', 'a', '1', '-', '.', '\0'};
+    std::vector<ScanInput> inputs;
+    std::mt19937 generator(1234U);
+    for (size_t size = 0U; size < 300U; ++size) {
+        for (uint32_t variant = 0U; variant < 8U; ++variant) {
+            ScanInput input;
+            input.name = "random_" + std::to_string(size) + "_" + std::to_string(variant);
+            for (size_t idx = 0U; idx < size; ++idx) {
+                // few separators in the odd variants, for have tokens longer than a block
+                const auto pick = generator() % ((variant & 1U) ? 64U : sizeof(chars));
+                input.text += (pick < sizeof(chars)) ? chars[pick] : 'x';
+            }
+            inputs.push_back(input);
+        }
+    }
+    return inputs;
+}
+
+// line by line and byte by byte split, the reference of the kernels
+static void getReference(const std::string& vText, ScanResult& vOutResult) {
+    vOutResult = ScanResult();
+    size_t begin = 0U;
+    while (begin < vText.size()) {
+        size_t end = vText.find('\n', begin);
+        const size_t next = (end == std::string::npos) ? vText.size() : end + 1U;
+        if (end == std::string::npos) {
+            end = vText.size();
+        }
+        size_t token_begin = std::string::npos;
+        for (size_t idx = begin; idx <= end; ++idx) {
+            const bool blank = (idx == end || vText[idx] == ' ' || vText[idx] == '\t' || vText[idx] == '\r');
+            if (!blank && token_begin == std::string::npos) {
+                token_begin = idx;
+            } else if (blank && token_begin != std::string::npos) {
+                vOutResult.tokens.push_back(token_begin);
+                vOutResult.tokens.push_back(idx);
+                token_begin = std::string::npos;
+            }
+        }
+        if (end > begin && vText[end - 1U] == '\r') {
+            --end;
+        }
+        vOutResult.line_ends.push_back(end);
+        begin = next;
+    }
+}
+
+static void scan(const std::string& vText, ScanResult& vOutResult) {
+    MdlToObj::scanText(vText.data(), vText.size(), vOutResult.line_ends, vOutResult.tokens);
+}
+
+static bool isSame(const ScanResult& vA, const ScanResult& vB) {
+    return (vA.line_ends == vB.line_ends && vA.tokens == vB.tokens);
+}
+
+static double getSeconds(const std::chrono::steady_clock::time_point& vStart) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - vStart).count();
+}
+
+static void printSyntax() {
+    std::cout << "MdlToObjScanBench Syntax : MdlToObjScanBench [options] [mdl files]" << std::endl;
+    std::cout << "  --samples dir   directory of the unzipped samples (default : " MDL_TO_OBJ_BENCH_SAMPLES_DIR ")" << std::endl;
+    std::cout << "  --repeat count  runs by file and kernel, the best time is kept (default : 10)" << std::endl;
+    std::cout << "  --verify        compare the kernels with the scalar kernel and with a byte by byte split, exit code 1 if they differ" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::string samples_dir = MDL_TO_OBJ_BENCH_SAMPLES_DIR;
+    std::vector<std::string> files;
+    uint32_t repeat = 10U;
+    bool verify = false;
+    for (int idx = 1; idx < argc; ++idx) {
+        const std::string arg = argv[idx];
+        if (arg == "--samples" && idx + 1 < argc) {
+            samples_dir = argv[++idx];
+        } else if (arg == "--repeat" && idx + 1 < argc) {
+            repeat = std::max((uint32_t)std::strtoul(argv[++idx], nullptr, 10), 1U);
+        } else if (arg == "--verify") {
+            verify = true;
+        } else if (!arg.empty() && arg[0] != '-') {
+            files.push_back(arg);
+        } else {
+            printSyntax();
+            return (arg == "-h" || arg == "--help") ? 0 : 1;
+        }
+    }
+    if (files.empty()) {
+        files = getMdlFiles(samples_dir);
+    }
+    std::vector<ScanInput> inputs;
+    for (const auto& file : files) {
+        ScanInput input;
+        input.name = file.substr(file.find_last_of("/\\") + 1U);
+        if (!readFile(file, input.text)) {
+            std::cout << "Fail to read " << file << std::endl;
+            return 1;
+        }
+        inputs.push_back(input);
+    }
+    if (inputs.empty()) {
+        std::cout << "No mdl files in " << samples_dir << std::endl;
+    }
+
+    std::vector<ScanLevel> levels;
+    for (const auto& level : {ScanLevel::Scalar, ScanLevel::SSE2, ScanLevel::AVX2}) {
+        if (MdlToObj::setScanLevel(level)) {
+            levels.push_back(level);
+        }
+    }
+    std::cout << "Best kernel : " << getLevelName(MdlToObj::getBestScanLevel()) << std::endl;
+
+    bool res = true;
+    if (verify) {
+        auto verify_inputs = inputs;
+        const auto random_inputs = getRandomInputs();
+        verify_inputs.insert(verify_inputs.end(), random_inputs.begin(), random_inputs.end());
+        size_t errors = 0U;
+        for (const auto& input : verify_inputs) {
+            ScanResult reference;
+            getReference(input.text, reference);
+            for (const auto& level : levels) {
+                MdlToObj::setScanLevel(level);
+                ScanResult result;
+                scan(input.text, result);
+                if (!isSame(result, reference)) {
+                    std::cout << input.name << " : " << getLevelName(level) << " differ" << std::endl;
+                    ++errors;
+                }
+            }
+        }
+        std::cout << "Verify " << verify_inputs.size() << " texts with " << levels.size() << " kernels : " << (errors ? "FAILED" : "OK") << std::endl;
+        res = (errors == 0U);
+    } else {
+        std::printf("%-30s %8s %12s %12s %10s %10s\n", "file", "kernel", "lines", "tokens", "time (s)", "MB/s");
+        ScanResult result;
+        for (const auto& input : inputs) {
+            for (const auto& level : levels) {
+                MdlToObj::setScanLevel(level);
+                double best = 0.0;
+                for (uint32_t run = 0U; run < repeat; ++run) {
+                    const auto start = std::chrono::steady_clock::now();
+                    scan(input.text, result);
+                    const auto seconds = getSeconds(start);
+                    if (!run || seconds < best) {
+                        best = seconds;
+                    }
+                }
+                std::printf("%-30s %8s %12zu %12zu %10.6f %10.1f\n", input.name.c_str(), getLevelName(level), result.line_ends.size(),
+                            result.tokens.size() / 2U, best, input.text.size() / (1024.0 * 1024.0) / std::max(best, 1e-9));
+                std::fflush(stdout);
+            }
+        }
+    }
+    MdlToObj::setScanLevel(MdlToObj::getBestScanLevel());
+    return res ? 0 : 1;
+}
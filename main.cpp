@@ -22,29 +22,528 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include <deque>
+#include <mutex>
+#include <cctype>
 #include <string>
+#include <cstdlib>
+#include <fstream>
+#include <new>
 #include "MdlToObj.hpp"
 
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+// the allocations are counted for the stats, only when asked, since the counter is shared by all the threads
+static bool s_CountAllocations = false;
+
+void* operator new(std::size_t vSize) {
+    if (s_CountAllocations) {
+        MdlToObj::getAllocationsCounter().fetch_add(1U, std::memory_order_relaxed);
+    }
+    if (void* ptr = std::malloc(vSize ? vSize : 1U)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+// gcc see a free of a pointer given by operator new, but our operator new use malloc
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* vPtr) noexcept {
+    std::free(vPtr);
+}
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+// a file to convert
+struct Job {
+    std::string src;
+    std::string dst;
+    uint64_t size = 0U;
+    bool success = false;
+    MdlToObj::Stats stats;
+    std::string stats_json;
+};
+
+static std::string getJsonString(const std::string& vStr) {
+    std::string res = "\"";
+    for (const auto& c : vStr) {
+        if (c == '"' || c == '\\') {
+            res += '\\';
+        }
+        res += c;
+    }
+    return res + "\"";
+}
+
+// 0: not found, 1: file, 2: directory
+static int getPathType(const std::string& vPath, uint64_t* vOutSize = nullptr) {
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExA(vPath.c_str(), GetFileExInfoStandard, &data)) {
+        return 0;
+    }
+    if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+        return 2;
+    }
+    if (vOutSize != nullptr) {
+        *vOutSize = ((uint64_t)data.nFileSizeHigh << 32U) | data.nFileSizeLow;
+    }
+    return 1;
+#else
+    struct stat st;
+    if (stat(vPath.c_str(), &st) != 0) {
+        return 0;
+    }
+    if (S_ISDIR(st.st_mode)) {
+        return 2;
+    }
+    if (vOutSize != nullptr) {
+        *vOutSize = (uint64_t)st.st_size;
+    }
+    return 1;
+#endif
+}
+
+static bool isMdlFile(const std::string& vPath) {
+    if (vPath.size() < 4U) {
+        return false;
+    }
+    auto ext = vPath.substr(vPath.size() - 4U);
+    for (auto& c : ext) {
+        c = (char)tolower((unsigned char)c);
+    }
+    return (ext == ".mdl");
+}
+
+// add the mdl files of vDir and of its sub directories
+static void collectMdlFiles(const std::string& vDir, std::vector<Job>& vOutJobs) {
+    std::vector<std::string> entries;
+#ifdef _WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE handle = FindFirstFileA((vDir + "\\*").c_str(), &data);
+    if (handle != INVALID_HANDLE_VALUE) {
+        do {
+            entries.push_back(data.cFileName);
+        } while (FindNextFileA(handle, &data));
+        FindClose(handle);
+    }
+#else
+    DIR* dir = opendir(vDir.c_str());
+    if (dir != nullptr) {
+        while (auto entry = readdir(dir)) {
+            entries.push_back(entry->d_name);
+        }
+        closedir(dir);
+    }
+#endif
+    std::sort(entries.begin(), entries.end());  // stable order whatever the file system
+    for (const auto& entry : entries) {
+        if (entry == "." || entry == "..") {
+            continue;
+        }
+        const auto path = vDir + "/" + entry;
+        Job job;
+        const auto type = getPathType(path, &job.size);
+        if (type == 2) {
+            collectMdlFiles(path, vOutJobs);
+        } else if (type == 1 && isMdlFile(path)) {
+            job.src = path;
+            vOutJobs.push_back(job);
+        }
+    }
+}
+
+static bool addInput(const std::string& vPath, std::vector<Job>& vOutJobs) {
+    Job job;
+    const auto type = getPathType(vPath, &job.size);
+    if (type == 2) {
+        collectMdlFiles(vPath, vOutJobs);
+    } else if (type == 1) {
+        job.src = vPath;
+        vOutJobs.push_back(job);
+    } else {
+        std::cout << "Input not found : " << vPath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// one line per input, the empty lines and the lines starting with # are skipped
+static bool addInputsFromList(const std::string& vListFile, std::vector<Job>& vOutJobs) {
+    std::ifstream list(vListFile);
+    if (!list.is_open()) {
+        std::cout << "Fail to open the file list " << vListFile << std::endl;
+        return false;
+    }
+    bool res = true;
+    std::string line;
+    while (std::getline(list, line)) {
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t')) {
+            line.pop_back();
+        }
+        if (!line.empty() && line[0] != '#') {
+            res &= addInput(line, vOutJobs);
+        }
+    }
+    return res;
+}
+
+// work stealing scheduler :
+// each worker have its own queue, sorted from the smallest to the biggest job.
+// a worker take the biggest job of its queue, and when empty steal the smallest job of another queue
+class WorkStealingPool {
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> jobs;
+    };
+    std::vector<Queue> m_Queues;
+
+public:
+    // vJobsBySize are the job indexs sorted from the biggest to the smallest
+    WorkStealingPool(const size_t& vWorkersCount, const std::vector<size_t>& vJobsBySize) : m_Queues(vWorkersCount) {
+        // dealt in round robin, so each queue get big and small jobs
+        for (size_t idx = 0U; idx < vJobsBySize.size(); ++idx) {
+            m_Queues[idx % vWorkersCount].jobs.push_front(vJobsBySize[idx]);
+        }
+    }
+    // vFunctor receive the index of the worker and the index of the job
+    template <typename TFunctor>
+    void run(const TFunctor& vFunctor) {
+        std::vector<std::thread> threads;
+        for (size_t idx = 1U; idx < m_Queues.size(); ++idx) {
+            threads.emplace_back([this, idx, &vFunctor]() { m_work(idx, vFunctor); });
+        }
+        m_work(0U, vFunctor);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+private:
+    template <typename TFunctor>
+    void m_work(const size_t& vWorkerIdx, const TFunctor& vFunctor) {
+        size_t job = 0U;
+        while (m_pop(vWorkerIdx, job) || m_steal(vWorkerIdx, job)) {
+            vFunctor(vWorkerIdx, job);
+        }
+    }
+    bool m_pop(const size_t& vWorkerIdx, size_t& vOutJob) {
+        auto& queue = m_Queues[vWorkerIdx];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.jobs.empty()) {
+            return false;
+        }
+        vOutJob = queue.jobs.back();
+        queue.jobs.pop_back();
+        return true;
+    }
+    bool m_steal(const size_t& vWorkerIdx, size_t& vOutJob) {
+        // the jobs are never added after the start, so one pass on the other queues is enough
+        for (size_t offset = 1U; offset < m_Queues.size(); ++offset) {
+            auto& queue = m_Queues[(vWorkerIdx + offset) % m_Queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.jobs.empty()) {
+                vOutJob = queue.jobs.front();
+                queue.jobs.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+static void printSyntax() {
+    std::cout << "MdlToObj Syntax : MdlToObj file_to_convert [file_to_save]" << std::endl;
+    std::cout << "                  MdlToObj [options] inputs..." << std::endl;
+    std::cout << "  inputs             mdl files, zip files containing a mdl file, or directories searched recursively for mdl files" << std::endl;
+    std::cout << "  --list file        file containing one input per line" << std::endl;
+    std::cout << "  -j count           count of files converted at the same time (default : count of cores)" << std::endl;
+    std::cout << "  --cache dir        directory of the parsed files cache, the unchanged files are not parsed again" << std::endl;
+    std::cout << "  --index            save the offsets, counts and bounds of the meshes in file.mdlindex, for find them without scan the file"
+              << std::endl;
+    std::cout << "  --only patterns    parse and save only the components matching the patterns (* and ?), ex : --only \"SolarPanel*,Body\""
+              << std::endl;
+    std::cout << "  --weld epsilon     merge the vertices closer than epsilon, and remove the degenerated faces" << std::endl;
+    std::cout << "  --vcache size      reorder the triangles for a vertex cache of this size (16 is a good choice)" << std::endl;
+    std::cout << "  --overdraw         with --vcache, sort the triangles clusters for reduce the overdraw" << std::endl;
+    std::cout << "  --normals          save the normals, smoothed for the smooth shaded models, by face for the others" << std::endl;
+    std::cout << "  --crease degrees   with --normals, the faces forming a bigger angle are not smoothed together (default : 180)" << std::endl;
+    std::cout << "  --merge            save once the identical materials, and merge the models with the same material and shading" << std::endl;
+    std::cout << "  --lods ratios      save simplified models in file_lod1.obj/.glb.., ex : --lods 0.5,0.25,0.1 for 50%, 25% and 10% of the triangles"
+              << std::endl;
+    std::cout << "  --precision mode   storage of the vertices and uvs : double (default), float, or q16 (16 bits in the bounds of each model)"
+              << std::endl;
+    std::cout << "  --log level        none, error (default), info (results of the passes) or debug (parse details)" << std::endl;
+    std::cout << "  --stats format     print the times, sizes, counts and memory of each file, in json or text" << std::endl;
+    std::cout << "  --glb              save a binary glTF file instead of the obj/mtl files" << std::endl;
+    std::cout << "  --stream           write the meshes as soon as parsed, for the files bigger than the memory (no --lods, --cache, --glb, --merge)"
+              << std::endl;
+    std::cout << "  --extract-textures extract the textures used by the model next to the obj file, for the zip inputs" << std::endl;
+}
+
 int main(int argc, char** argv) {
-    std::string file_path_name_to_open;
-    std::string file_path_name_to_save;
-    if (argc > 1) {
-        file_path_name_to_open = std::string(argv[1]);
-        if (argc > 2) {
-            file_path_name_to_save = std::string(argv[2]);
+    std::vector<std::string> inputs;
+    std::vector<std::string> lists;
+    uint32_t jobs_count = 0U;
+    bool extract_textures = false;
+    bool glb = false;
+    bool stream = false;
+    std::string cache_dir;
+    bool use_index = false;
+    std::vector<std::string> component_filter;
+    std::string stats_format;
+    MdlToObj::LogLevel log_level = MdlToObj::LogLevel::Error;
+    double weld_epsilon = -1.0;
+    uint32_t vertex_cache_size = 0U;
+    bool optimize_overdraw = false;
+    bool compute_normals = false;
+    double crease_angle = 180.0;
+    bool merge_models = false;
+    std::vector<double> lod_ratios;
+    Precision precision = Precision::Double;
+    for (int idx = 1; idx < argc; ++idx) {
+        const std::string arg = argv[idx];
+        if (arg == "--list" && idx + 1 < argc) {
+            lists.push_back(argv[++idx]);
+        } else if (arg == "-j" && idx + 1 < argc) {
+            jobs_count = (uint32_t)std::strtoul(argv[++idx], nullptr, 10);
+        } else if (arg == "--cache" && idx + 1 < argc) {
+            cache_dir = argv[++idx];
+        } else if (arg == "--index") {
+            use_index = true;
+        } else if (arg == "--only" && idx + 1 < argc) {
+            // comma separated patterns
+            const std::string patterns = argv[++idx];
+            for (size_t begin = 0U; begin <= patterns.size();) {
+                const auto end = std::min(patterns.find(',', begin), patterns.size());
+                if (end > begin) {
+                    component_filter.push_back(patterns.substr(begin, end - begin));
+                }
+                begin = end + 1U;
+            }
+        } else if (arg == "--weld" && idx + 1 < argc) {
+            weld_epsilon = std::strtod(argv[++idx], nullptr);
+        } else if (arg == "--vcache" && idx + 1 < argc) {
+            vertex_cache_size = (uint32_t)std::strtoul(argv[++idx], nullptr, 10);
+        } else if (arg == "--overdraw") {
+            optimize_overdraw = true;
+        } else if (arg == "--normals") {
+            compute_normals = true;
+        } else if (arg == "--crease" && idx + 1 < argc) {
+            crease_angle = std::strtod(argv[++idx], nullptr);
+        } else if (arg == "--merge") {
+            merge_models = true;
+        } else if (arg == "--lods" && idx + 1 < argc) {
+            // comma separated ratios
+            const char* ratio = argv[++idx];
+            char* end = nullptr;
+            for (double value = std::strtod(ratio, &end); end != ratio; value = std::strtod(ratio, &end)) {
+                lod_ratios.push_back(value);
+                ratio = (*end == ',') ? end + 1 : end;
+            }
+        } else if (arg == "--precision" && idx + 1 < argc) {
+            const std::string mode = argv[++idx];
+            if (mode == "double") {
+                precision = Precision::Double;
+            } else if (mode == "float") {
+                precision = Precision::Float;
+            } else if (mode == "q16") {
+                precision = Precision::Quantized16;
+            } else {
+                printSyntax();
+                return 1;
+            }
+        } else if (arg == "--stats" && idx + 1 < argc) {
+            stats_format = argv[++idx];
+            if (stats_format != "json" && stats_format != "text") {
+                printSyntax();
+                return 1;
+            }
+        } else if (arg == "--log" && idx + 1 < argc) {
+            const std::string level = argv[++idx];
+            if (level == "none") {
+                log_level = MdlToObj::LogLevel::None;
+            } else if (level == "error") {
+                log_level = MdlToObj::LogLevel::Error;
+            } else if (level == "info") {
+                log_level = MdlToObj::LogLevel::Info;
+            } else if (level == "debug") {
+                log_level = MdlToObj::LogLevel::Debug;
+            } else {
+                printSyntax();
+                return 1;
+            }
+        } else if (arg == "--glb") {
+            glb = true;
+        } else if (arg == "--stream") {
+            stream = true;
+        } else if (arg == "--extract-textures") {
+            extract_textures = true;
+        } else if (arg == "-h" || arg == "--help") {
+            printSyntax();
+            return 0;
+        } else {
+            inputs.push_back(arg);
         }
     }
 
-    if (!file_path_name_to_open.empty()) {
-        MdlToObj m;
-        if (m.openMdlFile(file_path_name_to_open)) {
-            if (m.saveObjFile(file_path_name_to_save)) {
-                return 0;
+    // the streaming conversion don't keep the models, so these options have no effect on it
+    if (stream) {
+        std::string ignored;
+        const std::pair<bool, const char*> options[] = {
+            {glb, "--glb"}, {!lod_ratios.empty(), "--lods"}, {!cache_dir.empty(), "--cache"}, {merge_models, "--merge"}};
+        for (const auto& option : options) {
+            if (option.first) {
+                ignored += std::string(ignored.empty() ? "" : ", ") + option.second;
+            }
+        }
+        if (!ignored.empty()) {
+            if (log_level != MdlToObj::LogLevel::None) {
+                std::cerr << "--stream can't be used with " << ignored << std::endl;
             }
+            return 1;
+        }
+    }
+
+    std::vector<Job> jobs;
+    bool inputs_ok = true;
+    // old syntax : MdlToObj file_to_convert file_to_save
+    if (lists.empty() && inputs.size() == 2U && getPathType(inputs[0]) == 1 &&  //
+        (getPathType(inputs[1]) == 0 || (getPathType(inputs[1]) == 1 && !isMdlFile(inputs[1])))) {
+        inputs_ok &= addInput(inputs[0], jobs);
+        if (!jobs.empty()) {
+            jobs[0].dst = inputs[1];
         }
     } else {
-        std::cout << "MdlToObj Syntax : MdlToObj file_to_convert [file_to_save]" << std::endl;
+        for (const auto& input : inputs) {
+            inputs_ok &= addInput(input, jobs);
+        }
+        for (const auto& list : lists) {
+            inputs_ok &= addInputsFromList(list, jobs);
+        }
     }
 
-    return 1;
+    if (jobs.empty()) {
+        if (inputs.empty() && lists.empty()) {
+            printSyntax();
+        }
+        return 1;
+    }
+
+    if (!cache_dir.empty() && getPathType(cache_dir) == 0) {
+#ifdef _WIN32
+        CreateDirectoryA(cache_dir.c_str(), nullptr);
+#else
+        mkdir(cache_dir.c_str(), 0755);
+#endif
+    }
+
+    // the cores are shared between the files converted at the same time and the threads of each conversion
+    const uint32_t cores_count = std::max(std::thread::hardware_concurrency(), 1U);
+    if (!jobs_count) {
+        jobs_count = cores_count;
+    }
+    jobs_count = (uint32_t)std::min<size_t>(jobs_count, jobs.size());
+    const uint32_t threads_per_job = std::max(cores_count / jobs_count, 1U);
+
+    // the biggest files first, so the small ones fill the gaps at the end
+    std::vector<size_t> jobs_by_size(jobs.size());
+    for (size_t idx = 0U; idx < jobs.size(); ++idx) {
+        jobs_by_size[idx] = idx;
+    }
+    std::stable_sort(jobs_by_size.begin(), jobs_by_size.end(), [&jobs](const size_t& a, const size_t& b) {  //
+        return jobs[a].size > jobs[b].size;
+    });
+
+    s_CountAllocations = !stats_format.empty();
+    const bool print_status = (jobs.size() > 1U && stats_format != "json");  // the json is alone on stdout
+    std::mutex print_mutex;
+    // one converter by worker, reset between the files so the storage of the models is reused
+    std::vector<MdlToObj> converters(jobs_count);
+    for (auto& m : converters) {
+        m.setThreadsCount(threads_per_job);
+        m.setExtractTextures(extract_textures);
+        m.setCacheDirectory(cache_dir);
+        m.setUseIndex(use_index);
+        m.setComponentFilter(component_filter);
+        m.setWeldEpsilon(weld_epsilon);
+        m.setVertexCacheSize(vertex_cache_size);
+        m.setOptimizeOverdraw(optimize_overdraw);
+        m.setComputeNormals(compute_normals);
+        m.setCreaseAngle(crease_angle);
+        m.setMergeModels(merge_models);
+        m.setLodRatios(lod_ratios);
+        m.setPrecision(precision);
+        m.setLogLevel(log_level);
+    }
+    WorkStealingPool pool(jobs_count, jobs_by_size);
+    pool.run([&](const size_t& vWorkerIdx, const size_t& vJobIdx) {
+        auto& job = jobs[vJobIdx];
+        auto& m = converters[vWorkerIdx];
+        m.reset();
+        if (stream) {
+            job.success = m.convertMdlFile(job.src, job.dst);
+        } else {
+            job.success = m.openMdlFile(job.src) && (glb ? m.saveGlbFile(job.dst) : m.saveObjFile(job.dst));
+        }
+        job.stats = m.getStats();
+        job.stats_json = m.getStatsJson();
+        if (print_status) {
+            std::lock_guard<std::mutex> lock(print_mutex);
+            std::cout << (job.success ? "[OK]     " : "[FAILED] ") << job.src << std::endl;
+        }
+    });
+
+    size_t success_count = 0U;
+    for (const auto& job : jobs) {
+        success_count += job.success ? 1U : 0U;
+    }
+    if (print_status) {
+        std::cout << success_count << "/" << jobs.size() << " files converted" << std::endl;
+    }
+
+    if (stats_format == "json") {
+        std::string json = "{\"files\":[";
+        for (size_t idx = 0U; idx < jobs.size(); ++idx) {
+            json += std::string(idx ? "," : "") + "\n{\"file\":" + getJsonString(jobs[idx].src) +
+                    ",\"success\":" + (jobs[idx].success ? "true" : "false") + ",\"stats\":" + jobs[idx].stats_json + "}";
+        }
+        std::cout << json << "\n]}" << std::endl;
+    } else if (stats_format == "text") {
+        for (const auto& job : jobs) {
+            const auto& st = job.stats;
+            size_t vertices = 0U;
+            size_t faces = 0U;
+            for (const auto& model : st.models) {
+                vertices += model.vertices;
+                faces += model.faces;
+            }
+            std::cout << job.src << " : load " << st.load_seconds << "s, parse " << st.parse_seconds << "s, process " << st.process_seconds
+                      << "s, write " << st.write_seconds << "s, " << st.models.size() << " models, " << vertices << " vertices, " << faces
+                      << " faces, " << st.mdl_bytes << " bytes parsed, " << st.written_bytes << " bytes written, " << st.allocations
+                      << " allocations, peak rss " << st.peak_rss / (1024U * 1024U) << " MB";
+            if (merge_models) {
+                std::cout << ", " << st.draw_calls_before << " -> " << st.draw_calls_after << " draw calls";
+            }
+            if (precision != Precision::Double) {
+                std::cout << ", max error " << st.vertices_error << " on the positions, " << st.uvs_error << " on the uvs";
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    return (inputs_ok && success_count == jobs.size()) ? 0 : 1;
 }